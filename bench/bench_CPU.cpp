@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "../src/CPU/CPU.h"
+#include "../src/CPU/State.h"
+#include "../src/FlatBus.h"
+#include "../src/NES.h"
+#include "../src/Rewind.h"
+#include "../src/RunAhead.h"
+
+namespace
+{
+    constexpr uint64_t cyclesPerRun = 50'000'000;
+    constexpr int runsPerBackend = 5;
+    constexpr uint16_t programStart = 0x8000;
+    constexpr int framesPerROMRun = 3000;
+    constexpr int saveStateIterations = 10'000;
+    constexpr double saveStateBudgetMicroseconds = 10.0;
+    constexpr std::size_t rewindBudget = 64 * 1024 * 1024;
+    constexpr int rewindFrames = 5 * 60 * 60;  // 5 minutes at 60 frames a second
+    constexpr int rewindCheckFrames = 300;
+    constexpr int evictionFrames = 3000;
+    constexpr std::size_t evictionStateSize = 4096;
+    constexpr int evictionChangesPerFrame = 16;
+    constexpr std::size_t evictionBudgets[] = { 32 * 1024, 512 * 1024 };  // Short of one keyframe interval, and a couple of them
+    constexpr int runAheadFrames = 600;
+
+    // ALU heavy loop over two pages of RAM using indexed, zero page, accumulator and branch instructions
+    const std::vector<uint8_t> aluLoop {
+        0xA2, 0x00,        // LDX #$00
+        0xBD, 0x00, 0x02,  // LDA $0200,X
+        0x69, 0x03,        // ADC #$03
+        0x9D, 0x00, 0x03,  // STA $0300,X
+        0x45, 0x10,        // EOR $10
+        0x2A,              // ROL A
+        0x85, 0x10,        // STA $10
+        0xE8,              // INX
+        0xD0, 0xF0,        // BNE $8002
+        0xE6, 0x20,        // INC $20
+        0x4C, 0x00, 0x80,  // JMP $8000
+    };
+
+    using RunFunction = void (CPU<FlatBus>::*)(uint64_t targetCycle);
+
+    enum class ROMBackend
+    {
+        interpreter,
+        blockCache,
+        jit
+    };
+
+    void benchmarkBackend(const char *name, RunFunction run)
+    {
+        CPUState initialState;
+        initialState.pc = programStart;
+        initialState.sp = 0xFD;
+        initialState.processorStatus = 0x24;
+
+        FlatBus bus;
+        for (size_t i = 0; i < aluLoop.size(); i++) {
+            bus.memoryWrite(programStart + i, aluLoop[i]);
+        }
+
+        double bestSeconds = 0.0;
+        uint64_t instructions = 0;
+
+        for (int i = 0; i < runsPerBackend; i++) {
+            CPU<FlatBus> cpu(initialState);
+            cpu.connectToBus(&bus);
+
+            const auto start = std::chrono::steady_clock::now();
+            (cpu.*run)(cyclesPerRun);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (i == 0 || elapsed.count() < bestSeconds) {
+                bestSeconds = elapsed.count();
+                instructions = cpu.getInstructionCount();
+            }
+        }
+
+        fmt::print("{:<16} {:>10.2f} M instructions/s {:>10.2f} M cycles/s\n",
+                   name, instructions / bestSeconds / 1e6, cyclesPerRun / bestSeconds / 1e6);
+    }
+
+    // Runs frames of a real ROM on the full NES bus, returning the best time in seconds
+    double benchmarkROM(const std::string &romPath, ROMBackend backend)
+    {
+        double bestSeconds = 0.0;
+        uint64_t cycles = 0;
+
+        NES nes(romPath);
+        nes.setBlockCacheEnabled(backend == ROMBackend::blockCache);
+        nes.setJITEnabled(backend == ROMBackend::jit);
+
+        for (int i = 0; i < runsPerBackend; i++) {
+            nes.reset();
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < framesPerROMRun; frame++) {
+                nes.runFrame();
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (i == 0 || elapsed.count() < bestSeconds) {
+                bestSeconds = elapsed.count();
+                cycles = nes.getCycleCount();
+            }
+        }
+
+        const char *name = backend == ROMBackend::interpreter ? "Interpreter"
+                         : backend == ROMBackend::blockCache ? "Block cache" : "JIT";
+
+        fmt::print("{:<16} {:>10.2f} frames/s {:>10.2f} M cycles/s\n",
+                   name, framesPerROMRun / bestSeconds, cycles / bestSeconds / 1e6);
+
+        return bestSeconds;
+    }
+
+    // Checks that a state replays to exactly the same state as the original run, then times saving and loading.
+    // Returns false if the round trip wasn't bit-exact or either direction was over budget.
+    bool benchmarkSaveStates(const std::string &romPath)
+    {
+        NES nes(romPath);
+        nes.setJITEnabled(true);
+
+        std::vector<uint8_t> saved(nes.getSaveStateSize());
+        std::vector<uint8_t> original(saved.size());
+        std::vector<uint8_t> replayed(saved.size());
+
+        for (int frame = 0; frame < 60; frame++) {
+            nes.runFrame();
+        }
+        nes.saveState(saved);
+
+        for (int frame = 0; frame < 60; frame++) {
+            nes.runFrame();
+        }
+        nes.saveState(original);
+
+        nes.loadState(saved);
+        for (int frame = 0; frame < 60; frame++) {
+            nes.runFrame();
+        }
+        nes.saveState(replayed);
+
+        const bool bitExact = original == replayed;
+
+        const auto saveStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < saveStateIterations; i++) {
+            nes.saveState(replayed);
+        }
+        const std::chrono::duration<double, std::micro> saveTime = std::chrono::steady_clock::now() - saveStart;
+
+        const auto loadStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < saveStateIterations; i++) {
+            nes.loadState(saved);
+        }
+        const std::chrono::duration<double, std::micro> loadTime = std::chrono::steady_clock::now() - loadStart;
+
+        const double saveMicroseconds = saveTime.count() / saveStateIterations;
+        const double loadMicroseconds = loadTime.count() / saveStateIterations;
+        const bool withinBudget = saveMicroseconds < saveStateBudgetMicroseconds && loadMicroseconds < saveStateBudgetMicroseconds;
+
+        fmt::print("State size: {} bytes\n", saved.size());
+        fmt::print("Save: {:.2f} us  Load: {:.2f} us  (budget {:.0f} us, {})\n",
+                   saveMicroseconds, loadMicroseconds, saveStateBudgetMicroseconds, withinBudget ? "ok" : "over budget");
+        fmt::print("Replay after load: {}\n", bitExact ? "bit-exact" : "MISMATCH");
+
+        return bitExact && withinBudget;
+    }
+
+    // Captures every frame into a rewind buffer, reporting the cost per frame and how much history the budget holds.
+    // Returns false if rewinding through the last few seconds doesn't give back exactly what was captured.
+    bool benchmarkRewind(const std::string &romPath)
+    {
+        NES nes(romPath);
+        nes.setJITEnabled(true);
+
+        std::vector<uint8_t> state(nes.getSaveStateSize());
+        std::vector<uint8_t> rewound(state.size());
+        std::vector<std::vector<uint8_t>> recentStates;
+
+        RewindBuffer rewindBuffer(state.size(), rewindBudget);
+        std::chrono::duration<double, std::micro> captureTime {};
+
+        for (int frame = 0; frame < rewindFrames; frame++) {
+            nes.runFrame();
+
+            const auto start = std::chrono::steady_clock::now();
+            nes.saveState(state);
+            rewindBuffer.capture(state);
+            captureTime += std::chrono::steady_clock::now() - start;
+
+            if (frame >= rewindFrames - rewindCheckFrames) {
+                recentStates.push_back(state);
+            }
+        }
+
+        const int heldFrames = rewindBuffer.getFrameCount();
+        const double bytesPerFrame = static_cast<double>(rewindBuffer.getUsedBytes()) / heldFrames;
+
+        bool exact = true;
+        for (auto it = recentStates.rbegin(); it != recentStates.rend(); ++it) {
+            exact &= rewindBuffer.rewind(rewound) && rewound == *it;
+        }
+
+        fmt::print("Capture: {:.2f} us/frame  Compressed: {:.0f} bytes/frame (state is {} bytes)\n",
+                   captureTime.count() / rewindFrames, bytesPerFrame, state.size());
+        fmt::print("Held: {} frames in {:.2f} MB, about {:.1f} minutes would fit in {} MB\n",
+                   heldFrames, rewindBuffer.getUsedBytes() / 1e6, rewindBudget / bytesPerFrame / 60 / 60,
+                   rewindBudget / (1024 * 1024));
+        fmt::print("Rewind through last {} frames: {}\n", rewindCheckFrames, exact ? "bit-exact" : "MISMATCH");
+
+        return exact;
+    }
+
+    // Captures far more than the budget holds, so the ring wraps many times over and keyframes are dropped with
+    // their deltas. The states are made up, with a few bytes changing every frame so deltas keep growing until the
+    // next keyframe, which makes the entries big enough to fill the ring rather than its index. The smaller budget
+    // can't hold a whole keyframe interval, so deltas keep evicting their own keyframe and have to start a new one.
+    // Returns false unless every frame still held rewinds exactly.
+    bool checkRewindEviction(std::size_t budget)
+    {
+        std::mt19937 random(budget);
+        std::vector<uint8_t> state(evictionStateSize);
+        std::vector<uint8_t> rewound(state.size());
+        std::deque<std::vector<uint8_t>> heldStates;
+
+        RewindBuffer rewindBuffer(state.size(), budget);
+
+        for (int frame = 0; frame < evictionFrames; frame++) {
+            for (int i = 0; i < evictionChangesPerFrame; i++) {
+                state[random() % state.size()] = static_cast<uint8_t>(random());
+            }
+
+            rewindBuffer.capture(state);
+
+            // What's held is always the newest run of frames
+            heldStates.push_back(state);
+            while (heldStates.size() > static_cast<std::size_t>(rewindBuffer.getFrameCount())) {
+                heldStates.pop_front();
+            }
+        }
+
+        const int heldFrames = rewindBuffer.getFrameCount();
+
+        bool exact = heldFrames > 0;
+        for (auto it = heldStates.rbegin(); it != heldStates.rend(); ++it) {
+            exact &= rewindBuffer.rewind(rewound) && rewound == *it;
+        }
+        exact &= !rewindBuffer.rewind(rewound);
+
+        fmt::print("{:>4} KB budget: {} of {} frames held, rewind through them: {}\n", budget / 1024, heldFrames,
+                   evictionFrames, exact ? "bit-exact" : "MISMATCH");
+
+        return exact;
+    }
+
+    // Runs a frame ahead and checks every frame shown is exactly the frame a plain run draws at the same point,
+    // including the lines drawn across the snapshot at each frame boundary. Reports what the extra frame costs.
+    bool benchmarkRunAhead(const std::string &romPath)
+    {
+        NES nes(romPath);
+        NES plainNES(romPath);
+        nes.setJITEnabled(true);
+        plainNES.setJITEnabled(true);
+
+        RunAhead runAhead(nes, 1);
+        plainNES.runFrame();
+
+        int mismatchedFrames = 0;
+        for (int frame = 0; frame < runAheadFrames; frame++) {
+            runAhead.runFrame();
+            plainNES.runFrame();
+
+            if (nes.getFrameBuffer() != plainNES.getFrameBuffer()) {
+                mismatchedFrames++;
+            }
+        }
+
+        fmt::print("Extra per frame: {:.2f} us\n", runAhead.getAverageExtraMicroseconds());
+        fmt::print("Shown frames: {} ({} mismatched)\n", mismatchedFrames == 0 ? "bit-exact" : "MISMATCH", mismatchedFrames);
+
+        return mismatchedFrames == 0;
+    }
+}
+
+// Usage: cpubench [rom.nes]
+int main(int argc, char *argv[])
+{
+    fmt::print("Opcode dispatch ({} cycles, best of {} runs)\n", cyclesPerRun, runsPerBackend);
+
+    benchmarkBackend("Function table", &CPU<FlatBus>::runUntilWithFunctionTable);
+#if defined(__GNUC__)
+    benchmarkBackend("Computed goto", &CPU<FlatBus>::runUntilWithComputedGoto);
+#endif
+    benchmarkBackend("Block cache", &CPU<FlatBus>::runUntilWithBlockCache);
+#if defined(NESBUDDY_JIT_SUPPORTED)
+    benchmarkBackend("JIT", &CPU<FlatBus>::runUntilWithJIT);
+#endif
+
+    fmt::print("\nRewind eviction ({} made up frames of {} bytes)\n", evictionFrames, evictionStateSize);
+
+    for (std::size_t budget : evictionBudgets) {
+        if (!checkRewindEviction(budget)) {
+            return 1;
+        }
+    }
+
+    if (argc > 1) {
+        fmt::print("\nROM workload: {} ({} frames, best of {} runs)\n", argv[1], framesPerROMRun, runsPerBackend);
+
+        const double interpreterSeconds = benchmarkROM(argv[1], ROMBackend::interpreter);
+        const double blockCacheSeconds = benchmarkROM(argv[1], ROMBackend::blockCache);
+
+        fmt::print("Block cache speedup: {:.2f}x\n", interpreterSeconds / blockCacheSeconds);
+
+#if defined(NESBUDDY_JIT_SUPPORTED)
+        const double jitSeconds = benchmarkROM(argv[1], ROMBackend::jit);
+
+        fmt::print("JIT speedup: {:.2f}x\n", interpreterSeconds / jitSeconds);
+#endif
+
+        fmt::print("\nSavestates ({} saves and loads)\n", saveStateIterations);
+
+        if (!benchmarkSaveStates(argv[1])) {
+            return 1;
+        }
+
+        fmt::print("\nRewind ({} frames, {} MB budget)\n", rewindFrames, rewindBudget / (1024 * 1024));
+
+        if (!benchmarkRewind(argv[1])) {
+            return 1;
+        }
+
+
+        fmt::print("\nRun-ahead ({} frames, 1 ahead)\n", runAheadFrames);
+
+        if (!benchmarkRunAhead(argv[1])) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
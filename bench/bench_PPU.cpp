@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "../src/PPU/PixelKernels.h"
+#include "../src/PPU/PPU.h"
+
+namespace
+{
+    constexpr int runsPerKernel = 5;
+    constexpr int tileDecodeIterations = 2000;  // Both pattern tables each time
+    constexpr int paletteFrames = 2000;
+    constexpr int hashFrames = 10'000;
+    constexpr std::size_t tileCount = 512;
+
+    using PixelKernels::InstructionSet;
+
+    struct Inputs
+    {
+        std::vector<uint8_t> patterns;
+        std::vector<uint8_t> indices;  // A frame of palette indices, with the unused top bits set on some
+        std::vector<uint32_t> colours;  // Opaque, like the console's palette
+        std::vector<uint32_t> translucentColours;
+    };
+
+    Inputs makeInputs()
+    {
+        std::mt19937 random(2024);
+        Inputs inputs;
+
+        inputs.patterns.resize(tileCount * 16);
+        for (uint8_t &byte : inputs.patterns) {
+            byte = static_cast<uint8_t>(random());
+        }
+
+        inputs.indices.resize(PPU::screenWidth * PPU::screenHeight);
+        for (uint8_t &index : inputs.indices) {
+            index = static_cast<uint8_t>(random());
+        }
+
+        inputs.translucentColours.resize(64);
+        for (uint32_t &colour : inputs.translucentColours) {
+            colour = static_cast<uint32_t>(random());
+        }
+
+        inputs.colours = inputs.translucentColours;
+        for (uint32_t &colour : inputs.colours) {
+            colour |= 0xFF000000;
+        }
+
+        return inputs;
+    }
+
+    // Checks the instruction set gives the same output as the scalar kernels, including for counts which leave
+    // a tail too short for a whole vector
+    bool matchesScalar(InstructionSet instructionSet, const Inputs &inputs)
+    {
+        std::vector<uint8_t> expectedPixels(tileCount * 64), expectedFlipped(tileCount * 64);
+        std::vector<uint8_t> pixels(tileCount * 64), flipped(tileCount * 64);
+
+        PixelKernels::setInstructionSet(InstructionSet::scalar);
+        PixelKernels::decodeTiles(inputs.patterns.data(), tileCount, expectedPixels.data(), expectedFlipped.data());
+        PixelKernels::setInstructionSet(instructionSet);
+        PixelKernels::decodeTiles(inputs.patterns.data(), tileCount, pixels.data(), flipped.data());
+
+        bool matches = pixels == expectedPixels && flipped == expectedFlipped;
+
+        for (const std::vector<uint32_t> *paletteColours : { &inputs.colours, &inputs.translucentColours }) {
+            const PixelKernels::PaletteTable palette(std::span<const uint32_t, 64>(paletteColours->data(), 64));
+            std::vector<uint32_t> expectedColours(inputs.indices.size()), colours(inputs.indices.size());
+
+            PixelKernels::setInstructionSet(InstructionSet::scalar);
+            PixelKernels::expandPalette(inputs.indices.data(), inputs.indices.size(), palette, expectedColours.data());
+            PixelKernels::setInstructionSet(instructionSet);
+
+            for (std::size_t count : { std::size_t { 256 }, std::size_t { 61 }, inputs.indices.size() }) {
+                std::fill(colours.begin(), colours.end(), 0);
+                PixelKernels::expandPalette(inputs.indices.data(), count, palette, colours.data());
+
+                matches = matches && std::equal(colours.begin(), colours.begin() + count, expectedColours.begin());
+            }
+        }
+
+        PixelKernels::setInstructionSet(InstructionSet::scalar);
+        const uint64_t expectedHash = PixelKernels::hashBytes(inputs.indices.data(), inputs.indices.size());
+        const uint64_t expectedTailHash = PixelKernels::hashBytes(inputs.indices.data(), 61);
+        PixelKernels::setInstructionSet(instructionSet);
+
+        matches = matches && PixelKernels::hashBytes(inputs.indices.data(), inputs.indices.size()) == expectedHash
+                          && PixelKernels::hashBytes(inputs.indices.data(), 61) == expectedTailHash;
+
+        return matches;
+    }
+
+    // Changing any one pixel, or swapping two lines, has to change the hash for it to be any use on frames
+    bool hashSpotsChanges(const Inputs &inputs)
+    {
+        std::vector<uint8_t> frame = inputs.indices;
+        const uint64_t originalHash = PixelKernels::hashBytes(frame.data(), frame.size());
+
+        for (std::size_t i = 0; i < frame.size(); i++) {
+            frame[i] ^= 0x01;
+            const bool changed = PixelKernels::hashBytes(frame.data(), frame.size()) != originalHash;
+            frame[i] ^= 0x01;
+
+            if (!changed) {
+                return false;
+            }
+        }
+
+        std::swap_ranges(frame.begin(), frame.begin() + PPU::screenWidth, frame.begin() + PPU::screenWidth);
+        return PixelKernels::hashBytes(frame.data(), frame.size()) != originalHash;
+    }
+
+    template <typename Function>
+    double timeBest(Function function)
+    {
+        double bestSeconds = 0.0;
+
+        for (int i = 0; i < runsPerKernel; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (i == 0 || elapsed.count() < bestSeconds) {
+                bestSeconds = elapsed.count();
+            }
+        }
+
+        return bestSeconds;
+    }
+
+    // Returns the time to decode both pattern tables, in microseconds
+    double benchmarkTileDecode(InstructionSet instructionSet, const Inputs &inputs)
+    {
+        std::vector<uint8_t> pixels(tileCount * 64), flipped(tileCount * 64);
+        PixelKernels::setInstructionSet(instructionSet);
+
+        const double seconds = timeBest([&] {
+            for (int i = 0; i < tileDecodeIterations; i++) {
+                PixelKernels::decodeTiles(inputs.patterns.data(), tileCount, pixels.data(), flipped.data());
+            }
+        });
+
+        const double microseconds = seconds * 1e6 / tileDecodeIterations;
+        fmt::print("{:<16} {:>10.2f} us per 512 tiles {:>10.2f} ns/tile\n",
+                   PixelKernels::getName(instructionSet), microseconds, microseconds * 1000 / tileCount);
+
+        return microseconds;
+    }
+
+    // Converts a frame a scanline at a time, the way it's uploaded. Returns microseconds per frame.
+    double benchmarkPaletteExpansion(InstructionSet instructionSet, const Inputs &inputs)
+    {
+        const PixelKernels::PaletteTable palette(std::span<const uint32_t, 64>(inputs.colours.data(), 64));
+        std::vector<uint32_t> colours(inputs.indices.size());
+        PixelKernels::setInstructionSet(instructionSet);
+
+        const double seconds = timeBest([&] {
+            for (int frame = 0; frame < paletteFrames; frame++) {
+                for (int line = 0; line < PPU::screenHeight; line++) {
+                    PixelKernels::expandPalette(&inputs.indices[line * PPU::screenWidth], PPU::screenWidth, palette,
+                                                &colours[line * PPU::screenWidth]);
+                }
+            }
+        });
+
+        const double microseconds = seconds * 1e6 / paletteFrames;
+        fmt::print("{:<16} {:>10.2f} us per frame {:>10.2f} pixels/ns\n",
+                   PixelKernels::getName(instructionSet), microseconds, inputs.indices.size() / (microseconds * 1000));
+
+        return microseconds;
+    }
+
+    // Returns microseconds to hash a whole frame
+    double benchmarkFrameHash(InstructionSet instructionSet, const Inputs &inputs)
+    {
+        PixelKernels::setInstructionSet(instructionSet);
+        volatile uint64_t hash = 0;  // Keeps the hashing from being optimised away
+
+        const double seconds = timeBest([&] {
+            for (int frame = 0; frame < hashFrames; frame++) {
+                hash = PixelKernels::hashBytes(inputs.indices.data(), inputs.indices.size());
+            }
+        });
+
+        const double microseconds = seconds * 1e6 / hashFrames;
+        fmt::print("{:<16} {:>10.2f} us per frame {:>10.2f} GB/s\n",
+                   PixelKernels::getName(instructionSet), microseconds, inputs.indices.size() / (microseconds * 1000));
+
+        return microseconds;
+    }
+}
+
+int main()
+{
+    const Inputs inputs = makeInputs();
+    const InstructionSet supported = PixelKernels::getSupportedInstructionSet();
+
+    std::vector<InstructionSet> instructionSets { InstructionSet::scalar };
+    for (InstructionSet instructionSet : { InstructionSet::ssse3, InstructionSet::avx2 }) {
+        if (instructionSet <= supported) {
+            instructionSets.push_back(instructionSet);
+        }
+    }
+
+    fmt::print("Detected: {}\n", PixelKernels::getName(supported));
+
+    for (InstructionSet instructionSet : instructionSets) {
+        if (!matchesScalar(instructionSet, inputs)) {
+            fmt::print("{} output doesn't match scalar\n", PixelKernels::getName(instructionSet));
+            return 1;
+        }
+    }
+
+    if (!hashSpotsChanges(inputs)) {
+        fmt::print("Frame hash missed a change\n");
+        return 1;
+    }
+
+    fmt::print("\nTile decode ({} x 512 tiles, best of {} runs)\n", tileDecodeIterations, runsPerKernel);
+
+    const double scalarDecode = benchmarkTileDecode(InstructionSet::scalar, inputs);
+    for (std::size_t i = 1; i < instructionSets.size(); i++) {
+        fmt::print("{} speedup: {:.2f}x\n", PixelKernels::getName(instructionSets[i]),
+                   scalarDecode / benchmarkTileDecode(instructionSets[i], inputs));
+    }
+
+    fmt::print("\nPalette to ARGB8888 ({} frames by scanline, best of {} runs)\n", paletteFrames, runsPerKernel);
+
+    const double scalarExpansion = benchmarkPaletteExpansion(InstructionSet::scalar, inputs);
+    for (std::size_t i = 1; i < instructionSets.size(); i++) {
+        fmt::print("{} speedup: {:.2f}x\n", PixelKernels::getName(instructionSets[i]),
+                   scalarExpansion / benchmarkPaletteExpansion(instructionSets[i], inputs));
+    }
+
+    fmt::print("\nFrame hash ({} frames, best of {} runs)\n", hashFrames, runsPerKernel);
+
+    const double scalarHash = benchmarkFrameHash(InstructionSet::scalar, inputs);
+    for (std::size_t i = 1; i < instructionSets.size(); i++) {
+        fmt::print("{} speedup: {:.2f}x\n", PixelKernels::getName(instructionSets[i]),
+                   scalarHash / benchmarkFrameHash(instructionSets[i], inputs));
+    }
+
+    return 0;
+}
@@ -1,10 +1,49 @@
 #include "Application.h"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
 #include <string>
+#include <string_view>
+
+#include <fmt/core.h>
 
 #include "Logger.h"
+#include "NES.h"
+
+namespace
+{
+    // ARGB8888 colour of each of the 64 entries the PPU's palette can hold
+    constexpr std::array<uint32_t, 64> consoleColours {
+        0xFF545454, 0xFF001E74, 0xFF081090, 0xFF300088, 0xFF440064, 0xFF5C0030, 0xFF540400, 0xFF3C1800,
+        0xFF202A00, 0xFF083A00, 0xFF004000, 0xFF003C00, 0xFF00323C, 0xFF000000, 0xFF000000, 0xFF000000,
+        0xFF989698, 0xFF084CC4, 0xFF3032EC, 0xFF5C1EE4, 0xFF8814B0, 0xFFA01464, 0xFF982220, 0xFF783C00,
+        0xFF545A00, 0xFF287200, 0xFF087C00, 0xFF007628, 0xFF006678, 0xFF000000, 0xFF000000, 0xFF000000,
+        0xFFECEEEC, 0xFF4C9AEC, 0xFF787CEC, 0xFFB062EC, 0xFFE454EC, 0xFFEC58B4, 0xFFEC6A64, 0xFFD48820,
+        0xFFA0AA00, 0xFF74C400, 0xFF4CD020, 0xFF38CC6C, 0xFF38B4CC, 0xFF3C3C3C, 0xFF000000, 0xFF000000,
+        0xFFECEEEC, 0xFFA8CCEC, 0xFFBCBCEC, 0xFFD4B2EC, 0xFFECAEEC, 0xFFECAED4, 0xFFECB4B0, 0xFFE4C490,
+        0xFFCCD278, 0xFFB4DE78, 0xFFA8E290, 0xFF98E2B4, 0xFFA0D6E4, 0xFFA0A2A0, 0xFF000000, 0xFF000000,
+    };
+
+    constexpr int framesPerDebugUpdate = 60;  // About once a second
+
+    // 3x5 pixel font for the debug overlay, a row per byte with the leftmost pixel in bit 2
+    constexpr std::string_view glyphCharacters = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.";
+    constexpr uint8_t glyphs[][5] {
+        { 2, 5, 7, 5, 5 }, { 6, 5, 6, 5, 6 }, { 3, 4, 4, 4, 3 }, { 6, 5, 5, 5, 6 }, { 7, 4, 6, 4, 7 },
+        { 7, 4, 6, 4, 4 }, { 3, 4, 5, 5, 3 }, { 5, 5, 7, 5, 5 }, { 7, 2, 2, 2, 7 }, { 1, 1, 1, 5, 2 },
+        { 5, 5, 6, 5, 5 }, { 4, 4, 4, 4, 7 }, { 5, 7, 7, 5, 5 }, { 6, 5, 5, 5, 5 }, { 2, 5, 5, 5, 2 },
+        { 6, 5, 6, 4, 4 }, { 2, 5, 5, 6, 3 }, { 6, 5, 6, 5, 5 }, { 3, 4, 2, 1, 6 }, { 7, 2, 2, 2, 2 },
+        { 5, 5, 5, 5, 7 }, { 5, 5, 5, 5, 2 }, { 5, 5, 7, 7, 5 }, { 5, 5, 2, 5, 5 }, { 5, 5, 2, 2, 2 },
+        { 7, 1, 2, 4, 7 }, { 7, 5, 5, 5, 7 }, { 2, 6, 2, 2, 7 }, { 6, 1, 2, 4, 7 }, { 6, 1, 2, 1, 6 },
+        { 5, 5, 7, 1, 1 }, { 7, 4, 6, 1, 6 }, { 3, 4, 7, 5, 7 }, { 7, 1, 2, 2, 2 }, { 7, 5, 7, 5, 7 },
+        { 7, 5, 7, 1, 6 }, { 0, 0, 0, 0, 2 },
+    };
+    static_assert(std::size(glyphs) == glyphCharacters.size());
+}
 
-Application::Application()
+Application::Application() : palette(consoleColours)
 {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) 
     {
@@ -20,19 +59,23 @@ Application::Application()
         Logger::printError("Window could not be created! SDL_Error: " + std::string(SDL_GetError()));
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    // Presenting waits for vsync, which only holds up this thread as emulation runs on its own
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 
     if (renderer == NULL) 
     {
         Logger::printError("Renderer could not be created! SDL_Error: " + std::string(SDL_GetError()));
     }
 
-    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, SCREEN_WIDTH, SCREEN_HEIGHT);
+    // Frames are written straight into the texture's memory, then the renderer scales them up to the window
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, PPU::screenWidth, PPU::screenHeight);
 
     if (texture == NULL) 
     {
         Logger::printError("Screen Texture could not be created! SDL_Error: " + std::string(SDL_GetError()));
     }
+
+    SDL_RenderSetLogicalSize(renderer, PPU::screenWidth, PPU::screenHeight);
 }
 
 Application::~Application()
@@ -53,19 +96,192 @@ void Application::pollEvents(bool &isRunning)
             case SDL_QUIT:
                 isRunning = false;
                 break;
+            case SDL_KEYDOWN:
+            case SDL_KEYUP:
+                if (event.key.keysym.sym == SDLK_F1 && event.type == SDL_KEYDOWN && !event.key.repeat)
+                {
+                    showDebugOverlay = !showDebugOverlay;
+                }
+                updateControllerButton(event.key.keysym.sym, event.type == SDL_KEYDOWN);
+                break;
+            case SDL_RENDER_TARGETS_RESET:
+            case SDL_RENDER_DEVICE_RESET:
+                textureHoldsFrame = false;  // Texture contents may have been lost, so the next frame goes up whatever
+                break;
         }
     }
 }
 
-void Application::updateScreen()
+void Application::updateControllerButton(SDL_Keycode key, bool pressed)
+{
+    Button button;
+
+    switch (key)
+    {
+        case SDLK_x:      button = Button::a; break;
+        case SDLK_z:      button = Button::b; break;
+        case SDLK_RSHIFT: button = Button::select; break;
+        case SDLK_RETURN: button = Button::start; break;
+        case SDLK_UP:     button = Button::up; break;
+        case SDLK_DOWN:   button = Button::down; break;
+        case SDLK_LEFT:   button = Button::left; break;
+        case SDLK_RIGHT:  button = Button::right; break;
+        default:
+            return;
+    }
+
+    const uint8_t mask = 1 << static_cast<int>(button);
+    controllerButtons = pressed ? (controllerButtons | mask) : (controllerButtons & ~mask);
+}
+
+// Menus, pauses and text boxes can sit on the same frame for seconds, and the texture already holds it then, so
+// only the copy to the window and the present happen. Those still go every frame to keep the cadence steady.
+void Application::updateScreen(const PPU::FrameBuffer &frame)
 {
-    // Render to texture
-    SDL_SetRenderTarget(renderer, texture);
+    const uint64_t frameHash = PixelKernels::hashBytes(frame.data(), frame.size());
+
+    if (textureHoldsFrame && frameHash == uploadedFrameHash)
+    {
+        recordFrame(false, 0.0);
+    }
+    else
+    {
+        const auto uploadStart = std::chrono::steady_clock::now();
+        textureHoldsFrame = uploadFrame(frame);
+        const std::chrono::duration<double, std::micro> uploadTime = std::chrono::steady_clock::now() - uploadStart;
+
+        uploadedFrameHash = frameHash;
+        recordFrame(true, uploadTime.count());
+    }
+
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
-
-    // Render to window
-    SDL_SetRenderTarget(renderer, NULL);
     SDL_RenderCopy(renderer, texture, NULL, NULL);
+
+    if (showDebugOverlay)
+    {
+        drawDebugOverlay();
+    }
+
     SDL_RenderPresent(renderer);
-}
\ No newline at end of file
+}
+
+// Palette indices are turned into colours directly in the locked texture, so there's no copy of the frame in
+// between. Rows can be padded, in which case they're converted one at a time.
+bool Application::uploadFrame(const PPU::FrameBuffer &frame)
+{
+    void *pixels;
+    int pitch;
+
+    if (SDL_LockTexture(texture, NULL, &pixels, &pitch) < 0)
+    {
+        Logger::printError("Screen Texture could not be locked! SDL_Error: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    if (pitch == PPU::screenWidth * static_cast<int>(sizeof(uint32_t)))
+    {
+        PixelKernels::expandPalette(frame.data(), frame.size(), palette, static_cast<uint32_t *>(pixels));
+    }
+    else
+    {
+        for (int line = 0; line < PPU::screenHeight; line++)
+        {
+            uint32_t *row = reinterpret_cast<uint32_t *>(static_cast<uint8_t *>(pixels) + line * pitch);
+            PixelKernels::expandPalette(&frame[line * PPU::screenWidth], PPU::screenWidth, palette, row);
+        }
+    }
+
+    SDL_UnlockTexture(texture);
+    return true;
+}
+
+// The overlay shows the mean and worst upload over the last second, rather than changing every frame
+void Application::recordFrame(bool uploaded, double uploadMicroseconds)
+{
+    if (uploaded)
+    {
+        uploadsMeasured++;
+        uploadMicrosecondsTotal += uploadMicroseconds;
+        uploadMicrosecondsMax = std::max(uploadMicrosecondsMax, uploadMicroseconds);
+    }
+
+    if (++framesMeasured < framesPerDebugUpdate)
+    {
+        return;
+    }
+
+    const std::string kernels = PixelKernels::getName(PixelKernels::getInstructionSet());
+    const double meanMicroseconds = uploadsMeasured != 0 ? uploadMicrosecondsTotal / uploadsMeasured : 0.0;
+
+    debugText = fmt::format("UPLOAD {:.1f}US\nMAX {:.1f}US\nSKIPPED {} OF {}\n{}", meanMicroseconds, uploadMicrosecondsMax,
+                            framesMeasured - uploadsMeasured, framesMeasured, kernels);
+
+    framesMeasured = 0;
+    uploadsMeasured = 0;
+    uploadMicrosecondsTotal = 0.0;
+    uploadMicrosecondsMax = 0.0;
+}
+
+// Drawn at the console's resolution over the top of the frame, so it gets scaled up with it
+void Application::drawDebugOverlay()
+{
+    if (debugText.empty())
+    {
+        return;
+    }
+
+    const int lines = static_cast<int>(std::count(debugText.begin(), debugText.end(), '\n')) + 1;
+    int longestLine = 0;
+
+    for (std::size_t start = 0; start <= debugText.size();)
+    {
+        const std::size_t end = std::min(debugText.find('\n', start), debugText.size());
+        longestLine = std::max(longestLine, static_cast<int>(end - start));
+        start = end + 1;
+    }
+
+    const SDL_Rect background { 2, 2, longestLine * 4 + 3, lines * 6 + 3 };
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_RenderFillRect(renderer, &background);
+
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    drawText(debugText, 4, 4);
+}
+
+// Only has the characters the overlay needs, anything else comes out as a space
+void Application::drawText(const std::string &text, int x, int y)
+{
+    int column = x;
+
+    for (const char character : text)
+    {
+        if (character == '\n')
+        {
+            column = x;
+            y += 6;
+            continue;
+        }
+
+        const std::size_t glyph = glyphCharacters.find(static_cast<char>(std::toupper(static_cast<unsigned char>(character))));
+
+        if (glyph != std::string_view::npos)
+        {
+            for (int row = 0; row < 5; row++)
+            {
+                for (int bit = 0; bit < 3; bit++)
+                {
+                    if (glyphs[glyph][row] & (4 >> bit))
+                    {
+                        const SDL_Rect pixel { column + bit, y + row, 1, 1 };
+                        SDL_RenderFillRect(renderer, &pixel);
+                    }
+                }
+            }
+        }
+
+        column += 4;
+    }
+}
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+
 #include <SDL.h>
 
+#include "PPU/PixelKernels.h"
+#include "PPU/PPU.h"
+
 constexpr int SCREEN_WIDTH { 512 };
 constexpr int SCREEN_HEIGHT { 480 };
 
@@ -12,11 +18,39 @@ public:
     ~Application();
 
     void pollEvents(bool &isRunning);
-    void updateScreen();
+    void updateScreen(const PPU::FrameBuffer &frame);
+
+    uint8_t getControllerButtons() const;  // Keyboard state of controller 1, bit per Button
 private:
     SDL_Window *window {};
     SDL_Renderer *renderer {};
-    SDL_Texture *texture {};
+    SDL_Texture *texture {};  // Streamed at the console's resolution and scaled up when it's copied to the window
 
     SDL_Event event;
-};
\ No newline at end of file
+
+    uint8_t controllerButtons {};
+
+    PixelKernels::PaletteTable palette;
+    uint64_t uploadedFrameHash {};
+    bool textureHoldsFrame {};  // Whether the texture still has the frame uploadedFrameHash came from
+
+    /* Debug overlay, toggled with F1 */
+    bool showDebugOverlay {};
+    int framesMeasured {};               // Since the overlay's text was last refreshed
+    int uploadsMeasured {};
+    double uploadMicrosecondsTotal {};
+    double uploadMicrosecondsMax {};
+    std::string debugText;
+
+    void updateControllerButton(SDL_Keycode key, bool pressed);
+
+    bool uploadFrame(const PPU::FrameBuffer &frame);
+    void recordFrame(bool uploaded, double uploadMicroseconds);
+    void drawDebugOverlay();
+    void drawText(const std::string &text, int x, int y);
+};
+
+inline uint8_t Application::getControllerButtons() const
+{
+    return controllerButtons;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/**
+ *  Cache of pre-decoded basic blocks used by the cached interpreter.
+ *  Blocks are keyed on their start address and the host pointer of the code they were decoded from, so a block
+ *  decoded from one PRG bank is never run after a different bank has been switched in at the same address.
+ *  Blocks never cross a 256 byte page, which lets them be invalidated per page when that page is written to.
+*/
+
+template <typename Handler>
+class BlockCache
+{
+public:
+    struct Instruction
+    {
+        Handler handler;
+        uint16_t operand;  // Operand bytes which followed the opcode
+        uint8_t opcode;
+        uint8_t length;    // Length of the instruction in bytes
+        uint8_t cycles;    // Base clock cycles
+    };
+
+    struct Block
+    {
+        const uint8_t *source { nullptr };  // Host pointer to the first opcode in the block
+        uint16_t address {};
+        uint16_t instructionCount {};
+        uint32_t firstInstruction {};
+        uint32_t maxCycles {};  // Upper bound on the clock cycles the whole block can take
+        uint32_t runCount {};   // Times the block has been run, used to find hot blocks
+        const void *nativeCode { nullptr };  // Machine code for the block once the JIT has compiled it
+    };
+
+    static constexpr int maxBlockLength = 32;
+    static constexpr int maxExtraCycles = 2;  // Taken branch to another page, or a page crossing read
+    static constexpr uint32_t maxBlockCycles = maxBlockLength * (7 + maxExtraCycles);  // No instruction takes over 7 base cycles
+
+    BlockCache();
+
+    Block *findBlock(uint16_t address, const uint8_t *source);
+    Block &beginBlock(uint16_t address, const uint8_t *source);
+    void addInstruction(Block &block, const Instruction &instruction);
+    const Instruction *getInstructions(const Block &block) const;
+
+    bool hasCodeInPage(uint16_t address) const;
+    const bool *getCodePageFlags() const;
+    void markCodePage(uint16_t address);  // For pages which mirror the memory a block was decoded from
+    void invalidatePage(uint16_t address);
+    void clear();
+
+private:
+    static constexpr int blockTableSize = 8192;
+    static constexpr int instructionPoolSize = 64 * 1024;
+
+    std::vector<Block> blockTable;  // Direct mapped on the block start address
+    std::vector<Instruction> instructionPool;
+    std::array<bool, 256> codePages {};  // Pages which at least one cached block was decoded from
+};
+
+template <typename Handler>
+BlockCache<Handler>::BlockCache() : blockTable(blockTableSize)
+{
+    instructionPool.reserve(instructionPoolSize);
+}
+
+template <typename Handler>
+inline typename BlockCache<Handler>::Block *BlockCache<Handler>::findBlock(uint16_t address, const uint8_t *source)
+{
+    Block &block = blockTable[address % blockTableSize];
+
+    if (block.source == source && block.address == address && block.instructionCount != 0) {
+        return &block;
+    }
+
+    return nullptr;
+}
+
+// Starts a new empty block in the slot for the given address, replacing whatever was there
+template <typename Handler>
+typename BlockCache<Handler>::Block &BlockCache<Handler>::beginBlock(uint16_t address, const uint8_t *source)
+{
+    if (instructionPool.size() + maxBlockLength > instructionPoolSize) {
+        clear();
+    }
+
+    Block &block = blockTable[address % blockTableSize];
+    block.source = source;
+    block.address = address;
+    block.instructionCount = 0;
+    block.firstInstruction = static_cast<uint32_t>(instructionPool.size());
+    block.maxCycles = 0;
+    block.runCount = 0;
+    block.nativeCode = nullptr;
+
+    codePages[address >> 8] = true;
+
+    return block;
+}
+
+// Instructions must be added to the most recently started block
+template <typename Handler>
+void BlockCache<Handler>::addInstruction(Block &block, const Instruction &instruction)
+{
+    instructionPool.push_back(instruction);
+    block.instructionCount++;
+    block.maxCycles += instruction.cycles + maxExtraCycles;
+}
+
+template <typename Handler>
+inline const typename BlockCache<Handler>::Instruction *BlockCache<Handler>::getInstructions(const Block &block) const
+{
+    return &instructionPool[block.firstInstruction];
+}
+
+template <typename Handler>
+inline bool BlockCache<Handler>::hasCodeInPage(uint16_t address) const
+{
+    return codePages[address >> 8];
+}
+
+template <typename Handler>
+inline const bool *BlockCache<Handler>::getCodePageFlags() const
+{
+    return codePages.data();
+}
+
+template <typename Handler>
+inline void BlockCache<Handler>::markCodePage(uint16_t address)
+{
+    codePages[address >> 8] = true;
+}
+
+// Drops every block which starts in the same page as the given address
+template <typename Handler>
+void BlockCache<Handler>::invalidatePage(uint16_t address)
+{
+    const uint16_t pageStart = address & 0xFF00;
+
+    for (int i = 0; i < 256; i++) {
+        Block &block = blockTable[(pageStart + i) % blockTableSize];
+
+        if ((block.address & 0xFF00) == pageStart) {
+            block = Block {};
+        }
+    }
+
+    codePages[address >> 8] = false;
+}
+
+template <typename Handler>
+void BlockCache<Handler>::clear()
+{
+    for (Block &block : blockTable) {
+        block = Block {};
+    }
+
+    instructionPool.clear();
+    codePages.fill(false);
+}
@@ -1,7 +1,16 @@
 #pragma once
 
-#include <bitset>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "BlockCache.h"
+#include "CodeBuffer.h"
+#include "OpcodeTable.h"
+#include "X64Emitter.h"
+#include "../SaveState.h"
 
 enum class Flags : unsigned char
 {
@@ -14,23 +23,72 @@ enum class Flags : unsigned char
     negativeFlag      = 7,
 };
 
-class NES;
+constexpr uint8_t getFlagMask(Flags flag)
+{
+    return 1 << static_cast<uint8_t>(flag);
+}
+
 struct CPUState;
 
+/**
+ *  The CPU is parameterised on the bus it is connected to so that memory accesses can be inlined into the core.
+ *  A bus needs to provide:
+ *      uint8_t memoryRead(uint16_t address);
+ *      void memoryWrite(uint16_t address, uint8_t value);
+ *      const uint8_t *getCodePointer(uint16_t address);  // Host pointer to the byte at address, or nullptr if it
+ *                                                        // isn't plain memory (only used by the block cache)
+ *      const MemoryMap &getMemoryMap();  // Page tables the JIT generates lookups into, also used by the block cache
+ *                                         // to find pages which mirror the same memory
+*/
+
+template <typename Bus>
 class CPU
 {
 public:
     CPU();
     CPU(CPUState &initialState);
 
-    void connectToNes(NES *nes);
+    void connectToBus(Bus *bus);
     void setToPowerUpState();
+    void reset();
+
+    int tick();
+    void runUntil(uint64_t targetCycle);
+
+    /* Opcode Dispatch Backends (runUntil uses the one selected at build time, they stop early for interrupts) */
+    void runUntilWithFunctionTable(uint64_t targetCycle);
+#if defined(__GNUC__)
+    void runUntilWithComputedGoto(uint64_t targetCycle);
+#endif
+    void runUntilWithBlockCache(uint64_t targetCycle);
+#if defined(NESBUDDY_JIT_SUPPORTED)
+    void runUntilWithJIT(uint64_t targetCycle);
+    int tickWithJIT();
+#endif
 
-    void tick();
+    void setBlockCacheEnabled(bool enabled);
+    void setJITEnabled(bool enabled);  // Falls back to the block cache on hosts the JIT doesn't support
+
+    /* Interrupt Lines */
+    void triggerNMI();               // NMI is edge triggered, so each call causes exactly one interrupt
+    void setIRQLine(bool asserted);  // IRQ is level triggered, and is taken whenever it is asserted and not masked
+
+    uint64_t getCycleCount();
+    uint64_t getCurrentCycle();  // Cycle the running instruction started on, for buses which time their accesses
+    uint64_t getInstructionCount();
 
     CPUState getState();
+    void setState(const CPUState &state);
+
+    void saveState(SaveState::Writer &writer) const;
+    void loadState(SaveState::Reader &reader);
 private:
-    NES *nes { nullptr };
+    Bus *bus { nullptr };
+
+    uint64_t cycles {};  // Total clock cycles elapsed since the CPU was created
+    uint16_t blockCycleOffset {};  // Base cycles run by the current block which haven't been added to cycles yet
+    uint64_t instructionCount {};  // Total instructions executed since the CPU was created
+    bool pageCrossed {};  // Set by indexed addressing modes when the effective address crosses a page boundary
 
     /* Registers */
     uint16_t pc {};          // Program Counter
@@ -39,116 +97,213 @@ private:
     uint8_t indexX {};       // Index Register X
     uint8_t indexY {};       // Index Register Y
 
-    /* Flags */
-    std::bitset<8> processorStatus { 0b0010'0000 };
+    /**
+     * Flags
+     * Zero and negative are evaluated lazily from the results which last affected them, so most
+     * instructions only need to store a byte. The full status byte is only assembled when it is read.
+    */
+    uint8_t zeroResult { 1 };      // Zero flag is set when this is 0
+    uint8_t negativeResult {};     // Negative flag is bit 7 of this
+    bool carry {};                 // Carry flag
+    bool overflow {};              // Overflow flag
+    uint8_t otherFlags { 0b0010'0000 };  // Interrupt disable, decimal mode, break command and unused bit
+
+    /**
+     * Interrupts
+     * Rather than polling the lines after every instruction, the run loops stop as soon as interruptPending is
+     * set and runUntil() takes the interrupt before carrying on. The cached interpreter and JIT only check
+     * between blocks, so an IRQ unmasked part way through a block is taken once that block has finished.
+    */
+    bool nmiPending {};
+    bool irqLine {};
+    bool interruptPending {};  // An interrupt will be taken before the next instruction
+
+    void updateInterruptPending();
+    int serviceInterrupt();
 
     /* Fetch-Decode-Execute */
     uint8_t fetchInstruct();
     int decodeAndExecuteInstruct(uint8_t instruction);
 
+    /**
+     * Generated Opcode Handlers
+     * OpcodeHandler fetches its own operand bytes and returns the total cycles taken.
+     * DecodedOpcodeHandler is given operand bytes decoded ahead of time by the block cache and only returns the
+     * cycles taken on top of the base cycles from the opcode table.
+    */
+    using OpcodeHandler = int (*)(CPU &cpu);
+    using DecodedOpcodeHandler = int (*)(CPU &cpu, uint16_t operand);
+
+    template <uint8_t opcode>
+    static int executeOpcode(CPU &cpu);
+
+    template <uint8_t opcode>
+    static int executeDecodedOpcode(CPU &cpu, uint16_t operand);
+
+    template <Operation operation, AddressingMode mode>
+    int execute(uint16_t operand);
+
+    template <std::size_t... opcodes>
+    static constexpr std::array<OpcodeHandler, 256> makeOpcodeHandlers(std::index_sequence<opcodes...>);
+
+    template <std::size_t... opcodes>
+    static constexpr std::array<DecodedOpcodeHandler, 256> makeDecodedOpcodeHandlers(std::index_sequence<opcodes...>);
+
+    static const std::array<OpcodeHandler, 256> opcodeHandlers;
+    static const std::array<DecodedOpcodeHandler, 256> decodedOpcodeHandlers;
+
+    /* Cached Interpreter */
+    using Cache = BlockCache<DecodedOpcodeHandler>;
+
+    std::unique_ptr<Cache> blockCache;  // Only allocated while the block cache is enabled
+    bool cachedCodeModified {};  // Set when a write invalidates cached blocks
+
+    typename Cache::Block *findOrCompileBlock(uint64_t cyclesLeft);
+    typename Cache::Block *compileBlock(uint16_t address, const uint8_t *source, int maxLength);
+
+    template <typename Function>
+    void forEachMirroredPage(uint16_t address, Function function);
+    void runBlock(const typename Cache::Block &block);
+
+    /**
+     * JIT Backend
+     * Hot blocks are translated to x86-64 with A, X, Y and the lazy zero/negative results held in host registers.
+    */
+    using NativeBlock = void (*)(CPU *cpu);
+
+    static constexpr uint32_t jitThreshold = 16;  // Times a block is run by the cached interpreter before it's compiled
+    static constexpr std::size_t jitBufferSize = 16 * 1024 * 1024;
+    static constexpr std::size_t maxNativeBlockSize = 16 * 1024;
+
+    std::unique_ptr<CodeBuffer> jitCode;  // Only allocated while the JIT is enabled
+
+    const void *compileNativeBlock(const typename Cache::Block &block);
+
+    static uint8_t jitMemoryRead(CPU *cpu, uint16_t address);
+    static void jitMemoryWrite(CPU *cpu, uint16_t address, uint8_t value);
+
+    /* Memory Write Helper (keeps the block cache coherent with self-modifying code) */
+    void writeMemory(uint16_t address, uint8_t value);
+
     /* Addressing Mode Handlers */
-    uint16_t getAbsoluteAddress();
-    uint16_t getAbsoluteXAddress();
-    uint16_t getAbsoluteYAddress();
-    uint8_t getImmediateValue();
-    uint16_t getIndirectAddress();
-    uint8_t getZeroPageAddress();
-    uint8_t getZeroPageXAddress();
-    uint8_t getZeroPageYAddress();
-    uint16_t getIndexedIndirectAddress();
-    uint16_t getIndirectIndexedAddress();
-    int8_t getRelativeOffset();
+    uint16_t getAbsoluteAddress(uint16_t operand);
+    uint16_t getAbsoluteXAddress(uint16_t operand);
+    uint16_t getAbsoluteYAddress(uint16_t operand);
+    uint8_t getImmediateValue(uint16_t operand);
+    uint16_t getIndirectAddress(uint16_t operand);
+    uint8_t getZeroPageAddress(uint16_t operand);
+    uint8_t getZeroPageXAddress(uint16_t operand);
+    uint8_t getZeroPageYAddress(uint16_t operand);
+    uint16_t getIndexedIndirectAddress(uint16_t operand);
+    uint16_t getIndirectIndexedAddress(uint16_t operand);
+    int8_t getRelativeOffset(uint16_t operand);
+
+    template <AddressingMode mode>
+    uint16_t getOperandAddress(uint16_t operand);
+
+    template <AddressingMode mode>
+    uint8_t getOperandValue(uint16_t operand);
 
     /* Processor Status Helper Functions */
     void setZN(uint8_t value);
+    uint8_t getProcessorStatus();
+    void setProcessorStatus(uint8_t status);
 
     /* Stack Helpers */
     void pushToStack(uint8_t value);
     uint8_t popFromStack();
+
+    /* Branch Helper */
+    int branch(bool condition, int8_t offset);
     
     /**
      * Instructions
     */
 
     /* Load/Store Operations */
-    int LDA(uint8_t value, int clockCycles);  // Load accumulator
-    int LDX(uint8_t value, int clockCycles);  // Load x register
-    int LDY(uint8_t value, int clockCycles);  // Load y register
-    int STA(uint16_t address, int clockCycles);  // Store accumulator
-    int STX(uint16_t address, int clockCycles);  // Store x register
-    int STY(uint16_t address, int clockCycles);  // Store y register
+    void LDA(uint8_t value);  // Load accumulator
+    void LDX(uint8_t value);  // Load x register
+    void LDY(uint8_t value);  // Load y register
+    void STA(uint16_t address);  // Store accumulator
+    void STX(uint16_t address);  // Store x register
+    void STY(uint16_t address);  // Store y register
 
     /* Register Transfers */
-    int TAX(int clockCycles);  // Transfer accumulator to x
-    int TAY(int clockCycles);  // Transfer accumulator to y
-    int TXA(int clockCycles);  // Transfer x to accumulator
-    int TYA(int clockCycles);  // Transfer y to accumulator
+    void TAX();  // Transfer accumulator to x
+    void TAY();  // Transfer accumulator to y
+    void TXA();  // Transfer x to accumulator
+    void TYA();  // Transfer y to accumulator
 
     /* Stack Operations */
-    int PHA(int clockCycles);  // Push accumulator
-    int PHP(int clockCycles);  // Push processor status
-    int PLA(int clockCycles);  // Pull accumulator
-    int PLP(int clockCycles);  // Pull processor status
-    int TSX(int clockCycles);  // Transfer stack pointer to x
-    int TXS(int clockCycles);  // Transfer x to stack pointer
+    void PHA();  // Push accumulator
+    void PHP();  // Push processor status
+    void PLA();  // Pull accumulator
+    void PLP();  // Pull processor status
+    void TSX();  // Transfer stack pointer to x
+    void TXS();  // Transfer x to stack pointer
 
     /* Logical */
-    int AND(uint8_t value, int clockCycles);  // Logical AND
-    int BIT(uint8_t value, int clockCycles);  // Bit test
-    int EOR(uint8_t value, int clockCycles);  // Exclusive OR
-    int ORA(uint8_t value, int clockCycles);  // Logical inclusive OR
+    void AND(uint8_t value);  // Logical AND
+    void BIT(uint8_t value);  // Bit test
+    void EOR(uint8_t value);  // Exclusive OR
+    void ORA(uint8_t value);  // Logical inclusive OR
 
     /* Arithmetic */
-    int ADC(uint8_t value, int clockCycles);  // Add with carry
-    int CMP(uint8_t value, int clockCycles);  // Compare
-    int CPX(uint8_t value, int clockCycles);  // Compare x register
-    int CPY(uint8_t value, int clockCycles);  // Compare y register
-    int SBC(uint8_t value, int clockCycles);  // Subtract with carry
+    void ADC(uint8_t value);  // Add with carry
+    void CMP(uint8_t value);  // Compare
+    void CPX(uint8_t value);  // Compare x register
+    void CPY(uint8_t value);  // Compare y register
+    void SBC(uint8_t value);  // Subtract with carry
 
     /* Increments and Decrements */
-    int DEC(uint16_t address, int clockCycles);  // Decrement memory
-    int DEX(int clockCycles);  // Decrement x register
-    int DEY(int clockCycles);  // Decrement y register
-    int INC(uint16_t address, int clockCycles);  // Increment memory
-    int INX(int clockCycles);  // Increment x register
-    int INY(int clockCycles);  // Increment y register
+    void DEC(uint16_t address);  // Decrement memory
+    void DEX();  // Decrement x register
+    void DEY();  // Decrement y register
+    void INC(uint16_t address);  // Increment memory
+    void INX();  // Increment x register
+    void INY();  // Increment y register
     
     /* Shifts */
-    int ASL(uint16_t address, int clockCycles);  // Arithmetic shift left
-    int ASL_a(int clockCycles);  // Same as above but only grabs value from accumulator
-    int LSR(uint16_t address, int clockCycles);  // Logical shift right
-    int LSR_a(int clockCycles);  // Same as above but only grabs value from accumulator
-    int ROL(uint16_t address, int clockCycles);  // Rotate left
-    int ROL_a(int clockCycles);  // Same as above but only grabs value from accumulator
-    int ROR(uint16_t address, int clockCycles);  // Rotate right
-    int ROR_a(int clockCycles);  // Same as above but only grabs value from accumulator
+    void ASL(uint16_t address);  // Arithmetic shift left
+    void ASL_a();  // Same as above but only grabs value from accumulator
+    void LSR(uint16_t address);  // Logical shift right
+    void LSR_a();  // Same as above but only grabs value from accumulator
+    void ROL(uint16_t address);  // Rotate left
+    void ROL_a();  // Same as above but only grabs value from accumulator
+    void ROR(uint16_t address);  // Rotate right
+    void ROR_a();  // Same as above but only grabs value from accumulator
 
     /* Jumps and Calls */
-    int JMP(uint16_t address, int clockCycles);  // Jump
-    int JSR(uint16_t address, int clockCycles);  // Jump to subroutine
-    int RTS(int clockCycles);  // Return from subroutine
-
-    /* Branches */
-    int BCC(int8_t offset, int clockCycles);  // Branch if carry clear
-    int BCS(int8_t offset, int clockCycles);  // Branch is carry set
-    int BEQ(int8_t offset, int clockCycles);  // Branch if equal
-    int BMI(int8_t offset, int clockCycles);  // Branch if minus
-    int BNE(int8_t offset, int clockCycles);  // Branch if not equal
-    int BPL(int8_t offset, int clockCycles);  // Branch if positive
-    int BVC(int8_t offset, int clockCycles);  // Branch if overflow clear
-    int BVS(int8_t offset, int clockCycles);  // Branch if overflow set
+    void JMP(uint16_t address);  // Jump
+    void JSR(uint16_t address);  // Jump to subroutine
+    void RTS();  // Return from subroutine
+
+    /* Branches (return the number of extra cycles taken) */
+    int BCC(int8_t offset);  // Branch if carry clear
+    int BCS(int8_t offset);  // Branch is carry set
+    int BEQ(int8_t offset);  // Branch if equal
+    int BMI(int8_t offset);  // Branch if minus
+    int BNE(int8_t offset);  // Branch if not equal
+    int BPL(int8_t offset);  // Branch if positive
+    int BVC(int8_t offset);  // Branch if overflow clear
+    int BVS(int8_t offset);  // Branch if overflow set
 
     /* Status Flag Changes */
-    int CLC(int clockCycles);  // Clear carry flag
-    int CLD(int clockCycles);  // Clear decimal mode
-    int CLI(int clockCycles);  // Clear interrupt disable
-    int CLV(int clockCycles);  // Clear overflow flag
-    int SEC(int clockCycles);  // Set carry flag
-    int SED(int clockCycles);  // Set decimal flag
-    int SEI(int clockCycles);  // Set interrupt disable
+    void CLC();  // Clear carry flag
+    void CLD();  // Clear decimal mode
+    void CLI();  // Clear interrupt disable
+    void CLV();  // Clear overflow flag
+    void SEC();  // Set carry flag
+    void SED();  // Set decimal flag
+    void SEI();  // Set interrupt disable
 
     /* System Functions */
-    int BRK(int clockCycles);  // Force interrupt
-    int NOP(int clockCycles);  // No operation
-    int RTI(int clockCycles);  // Return from interrupt
-};
\ No newline at end of file
+    void BRK();  // Force interrupt
+    void NOP();  // No operation
+    void RTI();  // Return from interrupt
+};
+
+#include "CPU.inl"
+#include "FetchDecodeExecute.inl"
+#include "Instructions.inl"
+#include "JIT.inl"
@@ -0,0 +1,454 @@
+#pragma once
+
+#include "State.h"
+#include "../MemoryMap.h"
+
+#if defined(NESBUDDY_COMPUTED_GOTO) && !defined(__GNUC__)
+    #error "Computed goto opcode dispatch requires GCC or Clang"
+#endif
+
+template <typename Bus>
+CPU<Bus>::CPU() {}
+
+template <typename Bus>
+CPU<Bus>::CPU(CPUState &initialState) {
+    setState(initialState);
+}
+
+template <typename Bus>
+void CPU<Bus>::connectToBus(Bus *bus)
+{
+    this->bus = bus;
+}
+
+template <typename Bus>
+void CPU<Bus>::setToPowerUpState()
+{
+    pc = (bus->memoryRead(0xFFFD) << 8) | bus->memoryRead(0xFFFC);
+    accumulator = 0;
+    indexX = 0;
+    indexY = 0;
+    sp = 0xFD;
+    setProcessorStatus(0x34);
+}
+
+// Puts the CPU back to how it was when it was created and powered up, without freeing and reallocating the
+// block cache or JIT code buffer. Cached code is dropped, as the bus is usually cleared alongside the CPU.
+template <typename Bus>
+void CPU<Bus>::reset()
+{
+    cycles = 0;
+    instructionCount = 0;
+
+    nmiPending = false;
+    irqLine = false;
+    interruptPending = false;
+    cachedCodeModified = false;
+
+    if (blockCache) {
+        blockCache->clear();
+    }
+    if (jitCode) {
+        jitCode->reset();
+    }
+
+    setToPowerUpState();
+}
+
+template <typename Bus>
+int CPU<Bus>::tick()
+{
+    // A pending interrupt takes the place of the next instruction
+    if (interruptPending) {
+        const int interruptCycles = serviceInterrupt();
+        cycles += interruptCycles;
+        return interruptCycles;
+    }
+
+    uint8_t instruction = fetchInstruct();
+    int clockCycles = decodeAndExecuteInstruct(instruction);
+    cycles += clockCycles;
+    return clockCycles;
+}
+
+// Runs whole instructions until the cycle counter reaches targetCycle, taking interrupts as they become pending
+template <typename Bus>
+void CPU<Bus>::runUntil(uint64_t targetCycle)
+{
+    while (cycles < targetCycle) {
+        if (interruptPending) {
+            cycles += serviceInterrupt();
+        }
+
+#if defined(NESBUDDY_JIT_SUPPORTED)
+        if (jitCode) {
+            runUntilWithJIT(targetCycle);
+            continue;
+        }
+#endif
+
+        if (blockCache) {
+            runUntilWithBlockCache(targetCycle);
+            continue;
+        }
+
+#if defined(NESBUDDY_COMPUTED_GOTO)
+        runUntilWithComputedGoto(targetCycle);
+#else
+        runUntilWithFunctionTable(targetCycle);
+#endif
+    }
+}
+
+template <typename Bus>
+void CPU<Bus>::setBlockCacheEnabled(bool enabled)
+{
+    if (!enabled) {
+        jitCode.reset();  // Compiled code is owned by the blocks, so it can't outlive them
+        blockCache.reset();
+    } else if (!blockCache) {
+        blockCache = std::make_unique<Cache>();
+    }
+}
+
+template <typename Bus>
+void CPU<Bus>::setJITEnabled(bool enabled)
+{
+#if defined(NESBUDDY_JIT_SUPPORTED)
+    if (enabled && !jitCode) {
+        setBlockCacheEnabled(true);
+        jitCode = std::make_unique<CodeBuffer>(jitBufferSize);
+    } else if (!enabled && jitCode) {
+        jitCode.reset();
+        blockCache->clear();  // Drops the blocks' pointers into the freed code
+    }
+#else
+    setBlockCacheEnabled(enabled);
+#endif
+}
+
+template <typename Bus>
+void CPU<Bus>::triggerNMI()
+{
+    nmiPending = true;
+    updateInterruptPending();
+}
+
+template <typename Bus>
+void CPU<Bus>::setIRQLine(bool asserted)
+{
+    irqLine = asserted;
+    updateInterruptPending();
+}
+
+// Needs calling whenever either line or the interrupt disable flag changes
+template <typename Bus>
+void CPU<Bus>::updateInterruptPending()
+{
+    interruptPending = nmiPending || (irqLine && !(otherFlags & getFlagMask(Flags::interruptDisable)));
+}
+
+// Pushes pc and status like BRK and jumps through the NMI or IRQ vector. Returns the cycles taken, which is
+// 0 if the IRQ was masked again before it could be taken.
+template <typename Bus>
+int CPU<Bus>::serviceInterrupt()
+{
+    uint16_t vector;
+
+    if (nmiPending) {
+        nmiPending = false;
+        vector = 0xFFFA;
+    } else if (irqLine && !(otherFlags & getFlagMask(Flags::interruptDisable))) {
+        vector = 0xFFFE;
+    } else {
+        interruptPending = false;
+        return 0;
+    }
+
+    pushToStack((pc >> 8) & 0xFF);
+    pushToStack(pc & 0xFF);
+    pushToStack(getProcessorStatus() & ~getFlagMask(Flags::breakCommand));
+
+    otherFlags |= getFlagMask(Flags::interruptDisable);
+    updateInterruptPending();
+
+    const uint8_t lowByte = bus->memoryRead(vector);
+    const uint8_t highByte = bus->memoryRead(vector + 1);
+
+    pc = (highByte << 8) | lowByte;
+
+    return 7;
+}
+
+template <typename Bus>
+uint64_t CPU<Bus>::getCycleCount()
+{
+    return cycles;
+}
+
+// Cached and compiled blocks only add their cycles to the counter once they exit, so they keep blockCycleOffset
+// up to date for whenever an instruction in the middle of one reaches the bus
+template <typename Bus>
+uint64_t CPU<Bus>::getCurrentCycle()
+{
+    return cycles + blockCycleOffset;
+}
+
+template <typename Bus>
+uint64_t CPU<Bus>::getInstructionCount()
+{
+    return instructionCount;
+}
+
+template <typename Bus>
+CPUState CPU<Bus>::getState()
+{
+    CPUState currentState;
+
+    currentState.pc = pc;
+    currentState.sp = sp;
+    currentState.accumulator = accumulator;
+    currentState.indexX = indexX;
+    currentState.indexY = indexY;
+    currentState.processorStatus = getProcessorStatus();
+
+    return currentState;
+}
+
+// Loads the registers only, the cycle and instruction counters carry on from where they were
+template <typename Bus>
+void CPU<Bus>::setState(const CPUState &state)
+{
+    pc = state.pc;
+    sp = state.sp;
+    accumulator = state.accumulator;
+    indexX = state.indexX;
+    indexY = state.indexY;
+    setProcessorStatus(state.processorStatus);
+    updateInterruptPending();
+}
+
+// Saves everything needed to carry on exactly where the CPU left off, including the counters and interrupt lines
+template <typename Bus>
+void CPU<Bus>::saveState(SaveState::Writer &writer) const
+{
+    writer.write(cycles);
+    writer.write(instructionCount);
+    writer.write(pc);
+    writer.write(sp);
+    writer.write(accumulator);
+    writer.write(indexX);
+    writer.write(indexY);
+    writer.write(zeroResult);
+    writer.write(negativeResult);
+    writer.write(carry);
+    writer.write(overflow);
+    writer.write(otherFlags);
+    writer.write(nmiPending);
+    writer.write(irqLine);
+}
+
+// Loading a state usually replaces RAM as well, so blocks decoded from writable pages are dropped. Blocks decoded
+// from ROM are kept, as they're keyed on the host memory they came from and so can't go stale.
+template <typename Bus>
+void CPU<Bus>::loadState(SaveState::Reader &reader)
+{
+    reader.read(cycles);
+    reader.read(instructionCount);
+    reader.read(pc);
+    reader.read(sp);
+    reader.read(accumulator);
+    reader.read(indexX);
+    reader.read(indexY);
+    reader.read(zeroResult);
+    reader.read(negativeResult);
+    reader.read(carry);
+    reader.read(overflow);
+    reader.read(otherFlags);
+    reader.read(nmiPending);
+    reader.read(irqLine);
+    updateInterruptPending();
+
+    if (blockCache) {
+        uint8_t *const *writePages = bus->getMemoryMap().getWritePageTable();
+
+        for (int page = 0; page < MemoryMap::pageCount; page++) {
+            if (writePages[page] != nullptr && blockCache->hasCodeInPage(page << 8)) {
+                blockCache->invalidatePage(page << 8);
+            }
+        }
+    }
+}
+
+/**
+ * Addressing Mode Handlers
+ * The operand bytes following the opcode have already been fetched (or pre-decoded by the block cache)
+ * and are passed in little endian order as a 16-bit value.
+*/
+
+template <typename Bus>
+uint16_t CPU<Bus>::getAbsoluteAddress(uint16_t operand)
+{
+    return operand;
+}
+
+template <typename Bus>
+uint16_t CPU<Bus>::getAbsoluteXAddress(uint16_t operand)
+{
+    uint16_t address = operand + indexX;
+    pageCrossed = (operand & 0xFF00) != (address & 0xFF00);
+    return address;
+}
+
+template <typename Bus>
+uint16_t CPU<Bus>::getAbsoluteYAddress(uint16_t operand)
+{
+    uint16_t address = operand + indexY;
+    pageCrossed = (operand & 0xFF00) != (address & 0xFF00);
+    return address;
+}
+
+template <typename Bus>
+uint8_t CPU<Bus>::getImmediateValue(uint16_t operand)
+{
+    return operand & 0xFF;
+}
+
+template <typename Bus>
+uint16_t CPU<Bus>::getIndirectAddress(uint16_t operand)
+{
+    uint16_t absoluteAddress = operand;
+    uint8_t byteOne = bus->memoryRead(absoluteAddress);
+
+    if ((absoluteAddress & 0x00FF) == 0xFF) {
+        absoluteAddress &= 0xFF00;
+    } else {
+        absoluteAddress++;
+    }
+    
+    uint8_t byteTwo = bus->memoryRead(absoluteAddress);
+    return (byteTwo << 8) | byteOne;
+}
+
+template <typename Bus>
+uint8_t CPU<Bus>::getZeroPageAddress(uint16_t operand)
+{
+    return operand & 0xFF;
+}
+
+template <typename Bus>
+uint8_t CPU<Bus>::getZeroPageXAddress(uint16_t operand)
+{
+    return (operand + indexX) & 0xFF;
+}
+
+template <typename Bus>
+uint8_t CPU<Bus>::getZeroPageYAddress(uint16_t operand)
+{
+    return (operand + indexY) & 0xFF;
+}
+
+template <typename Bus>
+uint16_t CPU<Bus>::getIndexedIndirectAddress(uint16_t operand)
+{
+    uint8_t address = (operand + indexX) & 0xFF;
+    uint8_t byteOne = bus->memoryRead(address);
+    address++;
+    uint8_t byteTwo = bus->memoryRead(address);
+    return (byteTwo << 8) | byteOne;
+}
+
+template <typename Bus>
+uint16_t CPU<Bus>::getIndirectIndexedAddress(uint16_t operand)
+{
+    uint8_t address = operand & 0xFF;
+    uint8_t byteOne = bus->memoryRead(address);
+    address++;
+    uint8_t byteTwo = bus->memoryRead(address);
+    uint16_t baseAddress = (byteTwo << 8) | byteOne;
+    uint16_t indexedAddress = baseAddress + indexY;
+    pageCrossed = (baseAddress & 0xFF00) != (indexedAddress & 0xFF00);
+    return indexedAddress;
+}
+
+template <typename Bus>
+int8_t CPU<Bus>::getRelativeOffset(uint16_t operand)
+{
+    return static_cast<int8_t>(operand & 0xFF);
+}
+
+template <typename Bus>
+void CPU<Bus>::setZN(uint8_t value)
+{
+    zeroResult = value;
+    negativeResult = value;
+}
+
+template <typename Bus>
+uint8_t CPU<Bus>::getProcessorStatus()
+{
+    uint8_t status = otherFlags;
+
+    status |= carry << static_cast<uint8_t>(Flags::carryFlag);
+    status |= (zeroResult == 0) << static_cast<uint8_t>(Flags::zeroFlag);
+    status |= overflow << static_cast<uint8_t>(Flags::overflowFlag);
+    status |= negativeResult & getFlagMask(Flags::negativeFlag);
+
+    return status;
+}
+
+template <typename Bus>
+void CPU<Bus>::setProcessorStatus(uint8_t status)
+{
+    carry = status & getFlagMask(Flags::carryFlag);
+    zeroResult = (status & getFlagMask(Flags::zeroFlag)) ? 0 : 1;
+    overflow = status & getFlagMask(Flags::overflowFlag);
+    negativeResult = status & getFlagMask(Flags::negativeFlag);
+
+    otherFlags = status & (getFlagMask(Flags::interruptDisable) | getFlagMask(Flags::decimalMode)
+                           | getFlagMask(Flags::breakCommand) | 0b0010'0000);
+}
+
+// All CPU writes go through here so that cached blocks decoded from the written page, or any page mirroring it,
+// are dropped
+template <typename Bus>
+void CPU<Bus>::writeMemory(uint16_t address, uint8_t value)
+{
+    bus->memoryWrite(address, value);
+
+    if (blockCache && blockCache->hasCodeInPage(address)) {
+        forEachMirroredPage(address, [this](uint16_t page) {
+            blockCache->invalidatePage(page);
+        });
+        cachedCodeModified = true;
+    }
+}
+
+template <typename Bus>
+void CPU<Bus>::pushToStack(uint8_t value)
+{
+    writeMemory(0x100 + sp, value);
+    sp--;
+}
+
+template <typename Bus>
+uint8_t CPU<Bus>::popFromStack()
+{
+    sp++;
+    return bus->memoryRead(0x100 + sp);
+}
+
+// Taken branches cost one extra cycle, plus another if the destination is on a different page
+template <typename Bus>
+int CPU<Bus>::branch(bool condition, int8_t offset)
+{
+    if (!condition) {
+        return 0;
+    }
+
+    const uint16_t destination = pc + offset;
+    const bool crossesPage = (pc & 0xFF00) != (destination & 0xFF00);
+    pc = destination;
+
+    return crossesPage ? 2 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "CodeBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+CodeBuffer::CodeBuffer(std::size_t size) : size(size)
+{
+#if defined(_WIN32)
+    memory = static_cast<uint8_t *>(VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READ));
+#else
+    void *mapping = mmap(nullptr, size, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    memory = mapping == MAP_FAILED ? nullptr : static_cast<uint8_t *>(mapping);
+#endif
+
+    if (memory == nullptr) {
+        throw std::runtime_error("Failed to allocate executable memory for the JIT.");
+    }
+}
+
+CodeBuffer::~CodeBuffer()
+{
+#if defined(_WIN32)
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, size);
+#endif
+}
+
+// Returns where the next piece of code should be written, which is valid for maxSize bytes until endWrite()
+uint8_t *CodeBuffer::beginWrite(std::size_t maxSize)
+{
+    writeSize = maxSize;
+    setExecutable(used, writeSize, false);
+    return memory + used;
+}
+
+void CodeBuffer::endWrite(std::size_t bytesWritten)
+{
+    setExecutable(used, writeSize, true);
+    used += bytesWritten;
+}
+
+void CodeBuffer::reset()
+{
+    used = 0;
+}
+
+std::size_t CodeBuffer::getFreeSpace() const
+{
+    return size - used;
+}
+
+// Protection can only be changed for whole pages, so the range is widened out to page boundaries
+void CodeBuffer::setExecutable(std::size_t offset, std::size_t length, bool executable)
+{
+    const std::size_t start = offset & ~(pageSize - 1);
+    const std::size_t end = std::min((offset + length + pageSize - 1) & ~(pageSize - 1), size);
+
+#if defined(_WIN32)
+    DWORD oldProtection;
+    VirtualProtect(memory + start, end - start, executable ? PAGE_EXECUTE_READ : PAGE_READWRITE, &oldProtection);
+    FlushInstructionCache(GetCurrentProcess(), memory + start, end - start);
+#else
+    mprotect(memory + start, end - start, executable ? (PROT_READ | PROT_EXEC) : (PROT_READ | PROT_WRITE));
+#endif
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ *  Block of memory for generated machine code. The buffer is only ever writable or executable, never both:
+ *  code is written between beginWrite() and endWrite(), which then flips it back to executable. Only the
+ *  pages being written are flipped, so the cost doesn't grow with the size of the buffer.
+ *  Code is never freed individually, the whole buffer is reset once it fills up.
+*/
+
+class CodeBuffer
+{
+public:
+    explicit CodeBuffer(std::size_t size);
+    ~CodeBuffer();
+
+    CodeBuffer(const CodeBuffer &) = delete;
+    CodeBuffer &operator=(const CodeBuffer &) = delete;
+
+    uint8_t *beginWrite(std::size_t maxSize);
+    void endWrite(std::size_t bytesWritten);
+    void reset();
+
+    std::size_t getFreeSpace() const;
+
+private:
+    static constexpr std::size_t pageSize = 4096;  // Smallest page size on the hosts the JIT supports
+
+    uint8_t *memory { nullptr };
+    std::size_t size {};
+    std::size_t used {};
+
+    std::size_t writeSize {};  // Size passed to the current beginWrite()
+
+    void setExecutable(std::size_t offset, std::size_t length, bool executable);
+};
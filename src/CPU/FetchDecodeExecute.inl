@@ -0,0 +1,449 @@
+#pragma once
+
+#include "../MemoryMap.h"
+
+template <typename Bus>
+uint8_t CPU<Bus>::fetchInstruct()
+{
+    uint8_t instruction = bus->memoryRead(pc);
+    pc++;
+    instructionCount++;
+    return instruction;
+}
+
+template <typename Bus>
+int CPU<Bus>::decodeAndExecuteInstruct(uint8_t instruction)
+{
+    return opcodeHandlers[instruction](*this);
+}
+
+template <typename Bus>
+template <AddressingMode mode>
+uint16_t CPU<Bus>::getOperandAddress(uint16_t operand)
+{
+    if constexpr (mode == AddressingMode::absolute) {
+        return getAbsoluteAddress(operand);
+    } else if constexpr (mode == AddressingMode::absoluteX) {
+        return getAbsoluteXAddress(operand);
+    } else if constexpr (mode == AddressingMode::absoluteY) {
+        return getAbsoluteYAddress(operand);
+    } else if constexpr (mode == AddressingMode::indirect) {
+        return getIndirectAddress(operand);
+    } else if constexpr (mode == AddressingMode::zeroPage) {
+        return getZeroPageAddress(operand);
+    } else if constexpr (mode == AddressingMode::zeroPageX) {
+        return getZeroPageXAddress(operand);
+    } else if constexpr (mode == AddressingMode::zeroPageY) {
+        return getZeroPageYAddress(operand);
+    } else if constexpr (mode == AddressingMode::indexedIndirect) {
+        return getIndexedIndirectAddress(operand);
+    } else {
+        static_assert(mode == AddressingMode::indirectIndexed, "Addressing mode doesn't resolve to a memory address");
+        return getIndirectIndexedAddress(operand);
+    }
+}
+
+template <typename Bus>
+template <AddressingMode mode>
+uint8_t CPU<Bus>::getOperandValue(uint16_t operand)
+{
+    if constexpr (mode == AddressingMode::immediate) {
+        return getImmediateValue(operand);
+    } else {
+        return bus->memoryRead(getOperandAddress<mode>(operand));
+    }
+}
+
+// Resolves the operand bytes for the given addressing mode and runs the instruction.
+// Returns the number of extra cycles taken on top of the opcode's base cycles.
+template <typename Bus>
+template <Operation operation, AddressingMode mode>
+int CPU<Bus>::execute(uint16_t operand)
+{
+    if constexpr (operation == Operation::LDA) {
+        LDA(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::LDX) {
+        LDX(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::LDY) {
+        LDY(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::STA) {
+        STA(getOperandAddress<mode>(operand));
+    } else if constexpr (operation == Operation::STX) {
+        STX(getOperandAddress<mode>(operand));
+    } else if constexpr (operation == Operation::STY) {
+        STY(getOperandAddress<mode>(operand));
+    } else if constexpr (operation == Operation::TAX) {
+        TAX();
+    } else if constexpr (operation == Operation::TAY) {
+        TAY();
+    } else if constexpr (operation == Operation::TXA) {
+        TXA();
+    } else if constexpr (operation == Operation::TYA) {
+        TYA();
+    } else if constexpr (operation == Operation::PHA) {
+        PHA();
+    } else if constexpr (operation == Operation::PHP) {
+        PHP();
+    } else if constexpr (operation == Operation::PLA) {
+        PLA();
+    } else if constexpr (operation == Operation::PLP) {
+        PLP();
+    } else if constexpr (operation == Operation::TSX) {
+        TSX();
+    } else if constexpr (operation == Operation::TXS) {
+        TXS();
+    } else if constexpr (operation == Operation::AND) {
+        AND(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::BIT) {
+        BIT(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::EOR) {
+        EOR(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::ORA) {
+        ORA(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::ADC) {
+        ADC(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::CMP) {
+        CMP(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::CPX) {
+        CPX(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::CPY) {
+        CPY(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::SBC) {
+        SBC(getOperandValue<mode>(operand));
+    } else if constexpr (operation == Operation::DEC) {
+        DEC(getOperandAddress<mode>(operand));
+    } else if constexpr (operation == Operation::DEX) {
+        DEX();
+    } else if constexpr (operation == Operation::DEY) {
+        DEY();
+    } else if constexpr (operation == Operation::INC) {
+        INC(getOperandAddress<mode>(operand));
+    } else if constexpr (operation == Operation::INX) {
+        INX();
+    } else if constexpr (operation == Operation::INY) {
+        INY();
+    } else if constexpr (operation == Operation::ASL) {
+        if constexpr (mode == AddressingMode::accumulator) {
+            ASL_a();
+        } else {
+            ASL(getOperandAddress<mode>(operand));
+        }
+    } else if constexpr (operation == Operation::LSR) {
+        if constexpr (mode == AddressingMode::accumulator) {
+            LSR_a();
+        } else {
+            LSR(getOperandAddress<mode>(operand));
+        }
+    } else if constexpr (operation == Operation::ROL) {
+        if constexpr (mode == AddressingMode::accumulator) {
+            ROL_a();
+        } else {
+            ROL(getOperandAddress<mode>(operand));
+        }
+    } else if constexpr (operation == Operation::ROR) {
+        if constexpr (mode == AddressingMode::accumulator) {
+            ROR_a();
+        } else {
+            ROR(getOperandAddress<mode>(operand));
+        }
+    } else if constexpr (operation == Operation::JMP) {
+        JMP(getOperandAddress<mode>(operand));
+    } else if constexpr (operation == Operation::JSR) {
+        JSR(getOperandAddress<mode>(operand));
+    } else if constexpr (operation == Operation::RTS) {
+        RTS();
+    } else if constexpr (operation == Operation::BCC) {
+        return BCC(getRelativeOffset(operand));
+    } else if constexpr (operation == Operation::BCS) {
+        return BCS(getRelativeOffset(operand));
+    } else if constexpr (operation == Operation::BEQ) {
+        return BEQ(getRelativeOffset(operand));
+    } else if constexpr (operation == Operation::BMI) {
+        return BMI(getRelativeOffset(operand));
+    } else if constexpr (operation == Operation::BNE) {
+        return BNE(getRelativeOffset(operand));
+    } else if constexpr (operation == Operation::BPL) {
+        return BPL(getRelativeOffset(operand));
+    } else if constexpr (operation == Operation::BVC) {
+        return BVC(getRelativeOffset(operand));
+    } else if constexpr (operation == Operation::BVS) {
+        return BVS(getRelativeOffset(operand));
+    } else if constexpr (operation == Operation::CLC) {
+        CLC();
+    } else if constexpr (operation == Operation::CLD) {
+        CLD();
+    } else if constexpr (operation == Operation::CLI) {
+        CLI();
+    } else if constexpr (operation == Operation::CLV) {
+        CLV();
+    } else if constexpr (operation == Operation::SEC) {
+        SEC();
+    } else if constexpr (operation == Operation::SED) {
+        SED();
+    } else if constexpr (operation == Operation::SEI) {
+        SEI();
+    } else if constexpr (operation == Operation::BRK) {
+        BRK();
+    } else if constexpr (operation == Operation::NOP) {
+        NOP();
+    } else if constexpr (operation == Operation::RTI) {
+        RTI();
+    }
+
+    return 0;
+}
+
+template <typename Bus>
+template <uint8_t opcode>
+int CPU<Bus>::executeOpcode(CPU &cpu)
+{
+    constexpr OpcodeInfo info = opcodeTable[opcode];
+    constexpr int operandLength = getOperandLength(info.addressingMode);
+
+    uint16_t operand = 0;
+
+    if constexpr (operandLength >= 1) {
+        operand = cpu.bus->memoryRead(cpu.pc);
+        cpu.pc++;
+    }
+
+    if constexpr (operandLength == 2) {
+        operand |= cpu.bus->memoryRead(cpu.pc) << 8;
+        cpu.pc++;
+    }
+
+    return info.cycles + executeDecodedOpcode<opcode>(cpu, operand);
+}
+
+template <typename Bus>
+template <uint8_t opcode>
+int CPU<Bus>::executeDecodedOpcode(CPU &cpu, uint16_t operand)
+{
+    constexpr OpcodeInfo info = opcodeTable[opcode];
+
+    const int extraCycles = cpu.execute<info.operation, info.addressingMode>(operand);
+
+    if constexpr (info.pageCrossPenalty) {
+        return extraCycles + cpu.pageCrossed;
+    } else {
+        return extraCycles;
+    }
+}
+
+template <typename Bus>
+template <std::size_t... opcodes>
+constexpr std::array<typename CPU<Bus>::OpcodeHandler, 256> CPU<Bus>::makeOpcodeHandlers(std::index_sequence<opcodes...>)
+{
+    return { &CPU::executeOpcode<opcodes>... };
+}
+
+template <typename Bus>
+template <std::size_t... opcodes>
+constexpr std::array<typename CPU<Bus>::DecodedOpcodeHandler, 256> CPU<Bus>::makeDecodedOpcodeHandlers(std::index_sequence<opcodes...>)
+{
+    return { &CPU::executeDecodedOpcode<opcodes>... };
+}
+
+template <typename Bus>
+const std::array<typename CPU<Bus>::OpcodeHandler, 256> CPU<Bus>::opcodeHandlers = CPU<Bus>::makeOpcodeHandlers(std::make_index_sequence<256> {});
+
+template <typename Bus>
+const std::array<typename CPU<Bus>::DecodedOpcodeHandler, 256> CPU<Bus>::decodedOpcodeHandlers = CPU<Bus>::makeDecodedOpcodeHandlers(std::make_index_sequence<256> {});
+
+template <typename Bus>
+void CPU<Bus>::runUntilWithFunctionTable(uint64_t targetCycle)
+{
+    while (cycles < targetCycle && !interruptPending) {
+        cycles += opcodeHandlers[fetchInstruct()](*this);
+    }
+}
+
+/**
+ * Cached Interpreter
+ * Runs of code up to the next control flow instruction are decoded once into a list of handlers with their
+ * operands, so running them again skips fetching and decoding. Code which isn't backed by plain memory
+ * (or a block which would run off the end of its page) is interpreted one instruction at a time instead.
+*/
+
+template <typename Bus>
+void CPU<Bus>::runUntilWithBlockCache(uint64_t targetCycle)
+{
+    setBlockCacheEnabled(true);
+
+    while (cycles < targetCycle && !interruptPending) {
+        const typename Cache::Block *block = findOrCompileBlock(targetCycle - cycles);
+
+        // Blocks which could overrun the target are left to the plain interpreter so runBlock() never has to check
+        if (block == nullptr || cycles + block->maxCycles > targetCycle) {
+            cycles += opcodeHandlers[fetchInstruct()](*this);
+        } else {
+            runBlock(*block);
+        }
+    }
+}
+
+// Returns the block starting at pc, or nullptr if pc isn't somewhere blocks can be decoded from.
+// New blocks aren't decoded when fewer than maxBlockCycles are left, as they'd most likely be too long to run.
+template <typename Bus>
+typename CPU<Bus>::Cache::Block *CPU<Bus>::findOrCompileBlock(uint64_t cyclesLeft)
+{
+    const uint8_t *source = bus->getCodePointer(pc);
+
+    if (source == nullptr) {
+        return nullptr;
+    }
+
+    typename Cache::Block *block = blockCache->findBlock(pc, source);
+
+    if (block == nullptr && cyclesLeft >= Cache::maxBlockCycles) {
+        block = compileBlock(pc, source, Cache::maxBlockLength);
+    }
+
+    return block;
+}
+
+// Decodes instructions from source until a jump, return or interrupt, the end of the page or the length limit
+template <typename Bus>
+typename CPU<Bus>::Cache::Block *CPU<Bus>::compileBlock(uint16_t address, const uint8_t *source, int maxLength)
+{
+    typename Cache::Block &block = blockCache->beginBlock(address, source);
+
+    // Writes through any mirror of the page have to invalidate the block too, not just writes to the page itself
+    forEachMirroredPage(address, [this](uint16_t page) {
+        blockCache->markCodePage(page);
+    });
+
+    const int bytesLeftInPage = 0x100 - (address & 0xFF);
+    int offset = 0;
+
+    while (block.instructionCount < maxLength) {
+        const uint8_t opcode = source[offset];
+        const OpcodeInfo &info = opcodeTable[opcode];
+        const int length = 1 + getOperandLength(info.addressingMode);
+
+        if (offset + length > bytesLeftInPage) {
+            break;
+        }
+
+        uint16_t operand = 0;
+
+        if (length >= 2) {
+            operand = source[offset + 1];
+        }
+
+        if (length == 3) {
+            operand |= source[offset + 2] << 8;
+        }
+
+        blockCache->addInstruction(block, {
+            decodedOpcodeHandlers[opcode], operand, opcode, static_cast<uint8_t>(length), info.cycles
+        });
+        offset += length;
+
+        // Conditional branches don't end the block, runBlock() leaves it early when one is taken instead
+        if (isControlFlow(info.operation) && info.addressingMode != AddressingMode::relative) {
+            break;
+        }
+    }
+
+    return block.instructionCount != 0 ? &block : nullptr;
+}
+
+// Calls function with the start of every page backed by the same host memory as the page holding address,
+// including that page itself. Pages which aren't plain memory only mirror themselves.
+template <typename Bus>
+template <typename Function>
+void CPU<Bus>::forEachMirroredPage(uint16_t address, Function function)
+{
+    const MemoryMap &memoryMap = bus->getMemoryMap();
+    const uint8_t *hostPage = memoryMap.getReadPage(address);
+
+    if (hostPage == nullptr) {
+        function(address & 0xFF00);
+        return;
+    }
+
+    const uint8_t *const *readPages = memoryMap.getReadPageTable();
+
+    for (int page = 0; page < MemoryMap::pageCount; page++) {
+        if (readPages[page] == hostPage) {
+            function(static_cast<uint16_t>(page << 8));
+        }
+    }
+}
+
+// Stops early when a branch is taken or an instruction invalidates cached code, as the block may have overwritten itself
+template <typename Bus>
+void CPU<Bus>::runBlock(const typename Cache::Block &block)
+{
+    const typename Cache::Instruction *instructions = blockCache->getInstructions(block);
+
+    // Kept in locals as the handlers are called through pointers and could otherwise touch them
+    uint64_t blockCycles = cycles;
+    int executed = 0;
+
+    cachedCodeModified = false;
+
+    while (executed < block.instructionCount) {
+        const typename Cache::Instruction &instruction = instructions[executed];
+        const uint16_t nextPc = pc + instruction.length;
+
+        pc = nextPc;
+        blockCycleOffset = static_cast<uint16_t>(blockCycles - cycles);
+        blockCycles += instruction.cycles + instruction.handler(*this, instruction.operand);
+        executed++;
+
+        if (pc != nextPc || cachedCodeModified) {
+            break;
+        }
+    }
+
+    blockCycleOffset = 0;
+    cycles = blockCycles;
+    instructionCount += executed;
+}
+
+#if defined(__GNUC__)
+
+#define OPCODE_ROW(high) \
+    OPCODE(high, 0) OPCODE(high, 1) OPCODE(high, 2) OPCODE(high, 3) \
+    OPCODE(high, 4) OPCODE(high, 5) OPCODE(high, 6) OPCODE(high, 7) \
+    OPCODE(high, 8) OPCODE(high, 9) OPCODE(high, A) OPCODE(high, B) \
+    OPCODE(high, C) OPCODE(high, D) OPCODE(high, E) OPCODE(high, F)
+
+#define ALL_OPCODES \
+    OPCODE_ROW(0) OPCODE_ROW(1) OPCODE_ROW(2) OPCODE_ROW(3) \
+    OPCODE_ROW(4) OPCODE_ROW(5) OPCODE_ROW(6) OPCODE_ROW(7) \
+    OPCODE_ROW(8) OPCODE_ROW(9) OPCODE_ROW(A) OPCODE_ROW(B) \
+    OPCODE_ROW(C) OPCODE_ROW(D) OPCODE_ROW(E) OPCODE_ROW(F)
+
+// Threaded dispatch using the labels as values extension. Each opcode ends with its own indirect jump
+// to the next handler instead of sharing a single one, which gives the host branch predictor more to work with.
+template <typename Bus>
+void CPU<Bus>::runUntilWithComputedGoto(uint64_t targetCycle)
+{
+#define OPCODE(high, low) &&opcode##high##low,
+    static void *const dispatchTable[256] = { ALL_OPCODES };
+#undef OPCODE
+
+#define DISPATCH() \
+    if (cycles >= targetCycle || interruptPending) { return; } \
+    goto *dispatchTable[fetchInstruct()];
+
+    DISPATCH();
+
+#define OPCODE(high, low) \
+    opcode##high##low: \
+    cycles += executeOpcode<0x##high##low>(*this); \
+    DISPATCH();
+
+    ALL_OPCODES
+
+#undef OPCODE
+#undef DISPATCH
+}
+
+#undef ALL_OPCODES
+#undef OPCODE_ROW
+
+#endif
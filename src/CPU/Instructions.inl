@@ -0,0 +1,556 @@
+#pragma once
+
+/**
+ * Load/Store Operations
+*/
+
+template <typename Bus>
+void CPU<Bus>::LDA(uint8_t value)
+{
+    accumulator = value;
+    setZN(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::LDX(uint8_t value)
+{
+    indexX = value;
+    setZN(indexX);
+}
+
+template <typename Bus>
+void CPU<Bus>::LDY(uint8_t value)
+{
+    indexY = value;
+    setZN(indexY);
+}
+
+template <typename Bus>
+void CPU<Bus>::STA(uint16_t address)
+{
+    writeMemory(address, accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::STX(uint16_t address)
+{
+    writeMemory(address, indexX);
+}
+
+template <typename Bus>
+void CPU<Bus>::STY(uint16_t address)
+{
+    writeMemory(address, indexY);
+}
+
+/**
+ * Stack Operations
+*/
+
+template <typename Bus>
+void CPU<Bus>::PHA()
+{
+    pushToStack(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::PHP()
+{
+    pushToStack(getProcessorStatus() | getFlagMask(Flags::breakCommand));
+    otherFlags &= ~getFlagMask(Flags::breakCommand);
+}
+
+template <typename Bus>
+void CPU<Bus>::PLA()
+{
+    accumulator = popFromStack();
+    setZN(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::PLP()
+{
+    setProcessorStatus((popFromStack() | 0x20) & ~getFlagMask(Flags::breakCommand));
+    updateInterruptPending();
+}
+
+template <typename Bus>
+void CPU<Bus>::TSX()
+{
+    indexX = sp;
+    setZN(indexX);
+}
+
+template <typename Bus>
+void CPU<Bus>::TXS()
+{
+    sp = indexX;
+}
+
+/**
+ * Logical
+*/
+
+template <typename Bus>
+void CPU<Bus>::AND(uint8_t value)
+{
+    accumulator &= value;
+    setZN(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::BIT(uint8_t value)
+{   
+    zeroResult = accumulator & value;
+    negativeResult = value;  // Negative and overflow are copied from bits 7 and 6 of the memory value
+    overflow = (value & 0x40) != 0;
+}
+
+template <typename Bus>
+void CPU<Bus>::EOR(uint8_t value)
+{
+    accumulator ^= value;
+    setZN(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::ORA(uint8_t value)
+{
+    accumulator |= value;
+    setZN(accumulator);
+}
+
+/**
+ * Arithmetic
+*/
+
+template <typename Bus>
+void CPU<Bus>::ADC(uint8_t value)
+{
+    uint16_t sum = accumulator + value;
+
+    if (carry) {
+        sum++;
+    }
+
+    carry = sum > 255;  // Set carry flag if overflow occurred
+
+    overflow = ~((accumulator ^ value) & 0x80) & ((accumulator ^ sum) & 0x80);  // Set overflow flag if twos complement overflow
+
+    accumulator = sum & 0xFF;
+
+    setZN(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::CMP(uint8_t value)
+{
+    const uint8_t result = accumulator - value;
+
+    carry = accumulator >= value;
+    
+    setZN(result);
+}
+
+template <typename Bus>
+void CPU<Bus>::CPX(uint8_t value)
+{
+    const uint8_t result = indexX - value;
+
+    carry = indexX >= value;
+    
+    setZN(result);
+}
+
+template <typename Bus>
+void CPU<Bus>::CPY(uint8_t value)
+{
+    const uint8_t result = indexY - value;
+
+    carry = indexY >= value;
+    
+    setZN(result);
+}
+
+template <typename Bus>
+void CPU<Bus>::SBC(uint8_t value)
+{
+    int16_t result = accumulator - value;
+
+    if (!carry) {
+        result--;
+    }
+
+    carry = result >= 0;  // Reset carry flag if overflow occurs
+
+    overflow = ((accumulator ^ value) & 0x80) & ((accumulator ^ (result & 0xFF)) & 0x80);  // Set overflow flag if twos complement overflow
+
+    accumulator = result & 0xFF;
+
+    setZN(accumulator);
+}
+
+/**
+ * Increments and Decrements
+*/
+
+template <typename Bus>
+void CPU<Bus>::DEC(uint16_t address)
+{
+    writeMemory(address, bus->memoryRead(address)-1);
+    setZN(bus->memoryRead(address));
+}
+
+template <typename Bus>
+void CPU<Bus>::DEX()
+{
+    indexX--;
+    setZN(indexX);
+}
+
+template <typename Bus>
+void CPU<Bus>::DEY()
+{
+    indexY--;
+    setZN(indexY);
+}
+
+template <typename Bus>
+void CPU<Bus>::INC(uint16_t address)
+{   
+    writeMemory(address, bus->memoryRead(address)+1);
+    setZN(bus->memoryRead(address));
+}
+
+template <typename Bus>
+void CPU<Bus>::INX()
+{
+    indexX++;
+    setZN(indexX);
+}
+
+template <typename Bus>
+void CPU<Bus>::INY()
+{
+    indexY++;
+    setZN(indexY);
+}
+
+/**
+ * Shifts
+*/
+
+template <typename Bus>
+void CPU<Bus>::ASL(uint16_t address)
+{
+    uint8_t value = bus->memoryRead(address);
+
+    carry = (value >> 7) == 1;  // Test bit 7 of input value
+
+    value <<= 1;
+
+    setZN(value);
+
+    writeMemory(address, value);
+}
+
+template <typename Bus>
+void CPU<Bus>::ASL_a()
+{
+    carry = (accumulator >> 7) == 1;  // Test bit 7 of input value
+
+    accumulator <<= 1;
+
+    setZN(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::LSR(uint16_t address)
+{
+    uint8_t value = bus->memoryRead(address);
+
+    carry = (value & 0x01) == 1;  // Test bit 0 of input value
+
+    value >>= 1;
+
+    setZN(value);
+
+    writeMemory(address, value);
+}
+
+template <typename Bus>
+void CPU<Bus>::LSR_a()
+{
+    carry = (accumulator & 0x01) == 1;  // Test bit 0 of input value
+
+    accumulator >>= 1;
+
+    setZN(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::ROL(uint16_t address)
+{
+    uint8_t value = bus->memoryRead(address);
+    
+    const bool carryOut = (value >> 7) == 1;  // Test bit 7 of input value
+
+    value <<= 1;
+    value |= carry;
+
+    carry = carryOut;
+
+    setZN(value);
+
+    writeMemory(address, value);
+}
+
+template <typename Bus>
+void CPU<Bus>::ROL_a()
+{   
+    const bool carryOut = (accumulator >> 7) == 1;  // Test bit 7 of input value
+
+    accumulator <<= 1;
+    accumulator |= carry;
+
+    carry = carryOut;
+
+    setZN(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::ROR(uint16_t address)
+{
+    uint8_t value = bus->memoryRead(address);
+    
+    const bool carryOut = (value & 0x01) == 1;  // Test bit 0 of input value
+
+    value >>= 1;
+    value |= (carry << 7);
+
+    carry = carryOut;
+
+    setZN(value);
+
+    writeMemory(address, value);
+}
+
+template <typename Bus>
+void CPU<Bus>::ROR_a()
+{
+    const bool carryOut = (accumulator & 0x01) == 1;  // Test bit 0 of input value
+
+    accumulator >>= 1;
+    accumulator |= (carry << 7);
+
+    carry = carryOut;
+
+    setZN(accumulator);
+}
+
+/**
+ * Jumps and Calls
+*/
+
+template <typename Bus>
+void CPU<Bus>::JMP(uint16_t address)
+{
+    pc = address;
+}
+
+template <typename Bus>
+void CPU<Bus>::JSR(uint16_t address)
+{
+    pc--;
+    pushToStack((pc >> 8) & 0xFF);
+    pushToStack(pc & 0xFF);
+    pc = address;
+}
+
+template <typename Bus>
+void CPU<Bus>::RTS()
+{
+    const uint8_t loByte = popFromStack();
+    const uint8_t hiByte = popFromStack();
+    uint16_t address = (hiByte << 8) | loByte; 
+    address++;
+    pc = address;
+}
+
+/**
+ * Branches
+*/
+
+template <typename Bus>
+int CPU<Bus>::BCC(int8_t offset)
+{
+    const bool carryIsClear = !carry;
+    return branch(carryIsClear, offset);
+}
+
+template <typename Bus>
+int CPU<Bus>::BCS(int8_t offset)
+{
+    const bool carryIsSet = carry;
+    return branch(carryIsSet, offset);
+}
+
+template <typename Bus>
+int CPU<Bus>::BEQ(int8_t offset)
+{
+    const bool isEqual = zeroResult == 0;
+    return branch(isEqual, offset);
+}
+
+template <typename Bus>
+int CPU<Bus>::BMI(int8_t offset)
+{
+    const bool isMinus = (negativeResult & 0x80) != 0;
+    return branch(isMinus, offset);
+}
+
+template <typename Bus>
+int CPU<Bus>::BNE(int8_t offset)
+{
+    const bool isNotEqual = zeroResult != 0;
+    return branch(isNotEqual, offset);
+}
+
+template <typename Bus>
+int CPU<Bus>::BPL(int8_t offset)
+{
+    const bool isPositive = (negativeResult & 0x80) == 0;
+    return branch(isPositive, offset);
+}
+
+template <typename Bus>
+int CPU<Bus>::BVC(int8_t offset)
+{
+    const bool overflowIsClear = !overflow;
+    return branch(overflowIsClear, offset);
+}
+
+template <typename Bus>
+int CPU<Bus>::BVS(int8_t offset)
+{
+    const bool overflowIsSet = overflow;
+    return branch(overflowIsSet, offset);
+}
+
+/**
+ * Register Transfers
+*/
+
+template <typename Bus>
+void CPU<Bus>::TAX()
+{
+    indexX = accumulator;
+    setZN(indexX);
+}
+
+template <typename Bus>
+void CPU<Bus>::TAY()
+{
+    indexY = accumulator;
+    setZN(indexY);
+}
+
+template <typename Bus>
+void CPU<Bus>::TXA()
+{
+    accumulator = indexX;
+    setZN(accumulator);
+}
+
+template <typename Bus>
+void CPU<Bus>::TYA()
+{
+    accumulator = indexY;
+    setZN(accumulator);
+}
+
+/**
+ * Status Flag Changes
+*/
+
+template <typename Bus>
+void CPU<Bus>::CLC()
+{
+    carry = false;
+}
+
+template <typename Bus>
+void CPU<Bus>::CLD()
+{
+    otherFlags &= ~getFlagMask(Flags::decimalMode);
+}
+
+template <typename Bus>
+void CPU<Bus>::CLI()
+{
+    otherFlags &= ~getFlagMask(Flags::interruptDisable);
+    updateInterruptPending();
+}
+
+template <typename Bus>
+void CPU<Bus>::CLV()
+{
+    overflow = false;
+}
+
+template <typename Bus>
+void CPU<Bus>::SEC()
+{
+    carry = true;
+}
+
+template <typename Bus>
+void CPU<Bus>::SED()
+{
+    otherFlags |= getFlagMask(Flags::decimalMode);
+}
+
+template <typename Bus>
+void CPU<Bus>::SEI()
+{
+    otherFlags |= getFlagMask(Flags::interruptDisable);
+}
+
+/**
+ * System Functions
+*/
+
+template <typename Bus>
+void CPU<Bus>::BRK()
+{
+    pc++;
+    pushToStack((pc >> 8) & 0xFF);
+    pushToStack(pc & 0xFF);
+
+    pushToStack(getProcessorStatus() | getFlagMask(Flags::breakCommand));
+
+    otherFlags &= ~getFlagMask(Flags::breakCommand);
+    otherFlags |= getFlagMask(Flags::interruptDisable);
+    
+    const uint8_t lowByte = bus->memoryRead(0xFFFE);
+    const uint8_t highByte = bus->memoryRead(0xFFFF);
+
+    pc = (highByte << 8) | lowByte; 
+}
+
+template <typename Bus>
+void CPU<Bus>::NOP()
+{
+}
+
+template <typename Bus>
+void CPU<Bus>::RTI()
+{
+    setProcessorStatus((popFromStack() | 0x20) & ~getFlagMask(Flags::breakCommand));
+    updateInterruptPending();
+
+    const uint8_t lowByte = popFromStack();
+    const uint8_t highByte = popFromStack();
+    
+    pc = (highByte << 8) | lowByte;
+}
\ No newline at end of file
@@ -0,0 +1,530 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "../MemoryMap.h"
+
+#if defined(NESBUDDY_JIT_SUPPORTED)
+
+/**
+ * JIT Backend
+ * Blocks from the block cache are run by the cached interpreter until they have been run jitThreshold times,
+ * then translated to x86-64. Loads, stores, transfers, increments, logic, compares and branches are generated
+ * inline; everything else calls the same decoded opcode handler the cached interpreter uses.
+ *
+ * Generated code looks memory up through the bus's page tables and only calls out to the bus for unmapped
+ * pages. Calls out set blockCycleOffset first, so the bus can still tell which cycle the access happened on.
+ * Stores to pages holding cached code also go through the bus, via writeMemory(), so the block can stop
+ * straight after overwriting code. Like the cached interpreter, blocks which could overrun the target cycle
+ * are interpreted instead, so the cycle count is exact whenever a block exits.
+*/
+
+template <typename Bus>
+void CPU<Bus>::runUntilWithJIT(uint64_t targetCycle)
+{
+    setJITEnabled(true);
+
+    while (cycles < targetCycle && !interruptPending) {
+        typename Cache::Block *block = findOrCompileBlock(targetCycle - cycles);
+
+        if (block == nullptr || cycles + block->maxCycles > targetCycle) {
+            cycles += opcodeHandlers[fetchInstruct()](*this);
+        } else if (block->nativeCode != nullptr) {
+            reinterpret_cast<NativeBlock>(block->nativeCode)(this);
+        } else if (++block->runCount >= jitThreshold) {
+            block->nativeCode = compileNativeBlock(*block);
+        } else {
+            runBlock(*block);
+        }
+    }
+}
+
+// Runs a single instruction as its own compiled block, so generated code can be checked instruction by instruction
+template <typename Bus>
+int CPU<Bus>::tickWithJIT()
+{
+    setJITEnabled(true);
+
+    const uint64_t startCycle = cycles;
+    const uint8_t *source = bus->getCodePointer(pc);
+    typename Cache::Block *block = source != nullptr ? compileBlock(pc, source, 1) : nullptr;
+
+    if (block != nullptr) {
+        block->nativeCode = compileNativeBlock(*block);
+    }
+
+    if (block != nullptr && block->nativeCode != nullptr) {
+        reinterpret_cast<NativeBlock>(block->nativeCode)(this);
+    } else {
+        cycles += opcodeHandlers[fetchInstruct()](*this);
+    }
+
+    return static_cast<int>(cycles - startCycle);
+}
+
+template <typename Bus>
+uint8_t CPU<Bus>::jitMemoryRead(CPU *cpu, uint16_t address)
+{
+    return cpu->bus->memoryRead(address);
+}
+
+template <typename Bus>
+void CPU<Bus>::jitMemoryWrite(CPU *cpu, uint16_t address, uint8_t value)
+{
+    cpu->writeMemory(address, value);
+}
+
+// Returns nullptr if the code buffer is full, in which case it is reset along with the block cache
+template <typename Bus>
+const void *CPU<Bus>::compileNativeBlock(const typename Cache::Block &block)
+{
+    using Reg = X64Emitter::Reg;
+    using Mem = X64Emitter::Mem;
+    using AluOp = X64Emitter::AluOp;
+    using Condition = X64Emitter::Condition;
+    using Label = X64Emitter::Label;
+
+    if (jitCode->getFreeSpace() < maxNativeBlockSize) {
+        jitCode->reset();
+        blockCache->clear();
+        return nullptr;
+    }
+
+    // 6502 state is kept in callee saved registers so calls out to the bus and handlers leave it alone
+    constexpr Reg cpuRegister = Reg::rbx;
+    constexpr Reg aRegister = Reg::r12;
+    constexpr Reg xRegister = Reg::r13;
+    constexpr Reg yRegister = Reg::r14;
+    constexpr Reg zeroRegister = Reg::r15;      // zeroResult
+    constexpr Reg negativeRegister = Reg::rbp;  // negativeResult
+
+#if defined(_WIN32)
+    constexpr Reg argumentRegisters[] = { Reg::rcx, Reg::rdx, Reg::r8 };
+    constexpr int stackReserve = 40;  // Shadow space, plus a scratch slot which also keeps the stack aligned
+#else
+    constexpr Reg argumentRegisters[] = { Reg::rdi, Reg::rsi, Reg::rdx };
+    constexpr int stackReserve = 8;   // Scratch slot which also keeps the stack aligned
+#endif
+
+    const Mem scratchSlot { Reg::rsp, stackReserve - 8 };
+
+    const auto field = [this](const void *member) {
+        return Mem { cpuRegister, static_cast<int32_t>(static_cast<const uint8_t *>(member) - reinterpret_cast<const uint8_t *>(this)) };
+    };
+
+    const Mem pcField = field(&pc);
+    const Mem spField = field(&sp);
+    const Mem accumulatorField = field(&accumulator);
+    const Mem indexXField = field(&indexX);
+    const Mem indexYField = field(&indexY);
+    const Mem zeroResultField = field(&zeroResult);
+    const Mem negativeResultField = field(&negativeResult);
+    const Mem carryField = field(&carry);
+    const Mem overflowField = field(&overflow);
+    const Mem cyclesField = field(&cycles);
+    const Mem blockCycleOffsetField = field(&blockCycleOffset);
+    const Mem instructionCountField = field(&instructionCount);
+    const Mem cachedCodeModifiedField = field(&cachedCodeModified);
+
+    const MemoryMap &memoryMap = bus->getMemoryMap();
+    const uint64_t readPages = reinterpret_cast<uint64_t>(memoryMap.getReadPageTable());
+    const uint64_t writePages = reinterpret_cast<uint64_t>(memoryMap.getWritePageTable());
+    const uint64_t codePages = reinterpret_cast<uint64_t>(blockCache->getCodePageFlags());
+
+    uint8_t *code = jitCode->beginWrite(maxNativeBlockSize);
+    X64Emitter emitter(code, maxNativeBlockSize);
+
+    // Exits which leave the block early. A pc of -1 means it has already been stored.
+    struct Exit
+    {
+        Label label;
+        int32_t pc;
+        uint32_t cycles;
+        int instructions;
+    };
+
+    std::vector<Exit> exits;
+    const Label epilogue = emitter.newLabel();
+
+    // Base cycles of the instructions before the one being generated
+    uint16_t instructionCycleOffset = 0;
+
+    // Wraps a call out of generated code, which is the only way anything outside can see the cycle counter
+    const auto emitCallOut = [&](const void *function) {
+        emitter.storeWordImm(blockCycleOffsetField, instructionCycleOffset);
+        emitter.call(function);
+        emitter.storeWordImm(blockCycleOffsetField, 0);
+    };
+
+    const auto addExit = [&](int32_t exitPc, uint32_t exitCycles, int exitInstructions) {
+        const Label label = emitter.newLabel();
+        exits.push_back({ label, exitPc, exitCycles, exitInstructions });
+        return label;
+    };
+
+    const auto spillRegisters = [&]() {
+        emitter.storeByte(accumulatorField, aRegister);
+        emitter.storeByte(indexXField, xRegister);
+        emitter.storeByte(indexYField, yRegister);
+        emitter.storeByte(zeroResultField, zeroRegister);
+        emitter.storeByte(negativeResultField, negativeRegister);
+    };
+
+    const auto reloadRegisters = [&]() {
+        emitter.movzxByte(aRegister, accumulatorField);
+        emitter.movzxByte(xRegister, indexXField);
+        emitter.movzxByte(yRegister, indexYField);
+        emitter.movzxByte(zeroRegister, zeroResultField);
+        emitter.movzxByte(negativeRegister, negativeResultField);
+    };
+
+    const auto setZN = [&](Reg value) {
+        emitter.mov32(zeroRegister, value);
+        emitter.mov32(negativeRegister, value);
+    };
+
+    const auto isInlineMode = [](AddressingMode mode) {
+        switch (mode) {
+            case AddressingMode::immediate:
+            case AddressingMode::zeroPage:
+            case AddressingMode::zeroPageX:
+            case AddressingMode::zeroPageY:
+            case AddressingMode::absolute:
+            case AddressingMode::absoluteX:
+            case AddressingMode::absoluteY:
+                return true;
+            default:
+                return false;
+        }
+    };
+
+    // Leaves the effective address in ecx, adding the page crossing cycle straight to the cycle counter
+    const auto emitAddress = [&](AddressingMode mode, uint16_t operand, bool pageCrossPenalty) {
+        switch (mode) {
+            case AddressingMode::zeroPage:
+                emitter.movImm32(Reg::rcx, operand & 0xFF);
+                break;
+            case AddressingMode::zeroPageX:
+            case AddressingMode::zeroPageY:
+                emitter.lea32(Reg::rcx, Mem { mode == AddressingMode::zeroPageX ? xRegister : yRegister, operand & 0xFF });
+                emitter.movzxByte(Reg::rcx, Reg::rcx);
+                break;
+            case AddressingMode::absoluteX:
+            case AddressingMode::absoluteY: {
+                emitter.lea32(Reg::rcx, Mem { mode == AddressingMode::absoluteX ? xRegister : yRegister, operand });
+
+                if (pageCrossPenalty) {
+                    const Label samePage = emitter.newLabel();
+                    emitter.alu32Imm(AluOp::cmp, Reg::rcx, operand | 0xFF);
+                    emitter.jcc(Condition::belowOrEqual, samePage);
+                    emitter.add64Imm(cyclesField, 1);
+                    emitter.bind(samePage);
+                }
+
+                emitter.movzxWord(Reg::rcx, Reg::rcx);
+                break;
+            }
+            default:
+                emitter.movImm32(Reg::rcx, operand);
+                break;
+        }
+    };
+
+    // Reads the byte at the address in ecx into ecx
+    const auto emitRead = [&]() {
+        const Label slowPath = emitter.newLabel();
+        const Label done = emitter.newLabel();
+
+        emitter.mov32(Reg::rax, Reg::rcx);
+        emitter.shr32Imm(Reg::rax, 8);
+        emitter.movImm64(Reg::rdx, readPages);
+        emitter.load64(Reg::rax, Mem { Reg::rdx, 0, Reg::rax, 8 });
+        emitter.test64(Reg::rax, Reg::rax);
+        emitter.jcc(Condition::equal, slowPath);
+        emitter.movzxByte(Reg::rdx, Reg::rcx);
+        emitter.movzxByte(Reg::rcx, Mem { Reg::rax, 0, Reg::rdx, 1 });
+        emitter.jmp(done);
+
+        emitter.bind(slowPath);
+        emitter.mov32(argumentRegisters[1], Reg::rcx);
+        emitter.mov64(argumentRegisters[0], cpuRegister);
+        emitCallOut(reinterpret_cast<const void *>(&CPU::jitMemoryRead));
+        emitter.movzxByte(Reg::rcx, Reg::rax);
+
+        emitter.bind(done);
+    };
+
+    // Writes value to the address in ecx, leaving through codeModified if the write invalidated cached code.
+    // Writes by the last instruction in a block don't need to check, as the block is about to end anyway.
+    const auto emitWrite = [&](Reg value, std::optional<Label> codeModified) {
+        const Label slowPath = emitter.newLabel();
+        const Label done = emitter.newLabel();
+
+        emitter.mov32(Reg::rax, Reg::rcx);
+        emitter.shr32Imm(Reg::rax, 8);
+        emitter.movImm64(Reg::rdx, codePages);
+        emitter.cmpByteImm(Mem { Reg::rdx, 0, Reg::rax, 1 }, 0);
+        emitter.jcc(Condition::notEqual, slowPath);
+        emitter.movImm64(Reg::rdx, writePages);
+        emitter.load64(Reg::rax, Mem { Reg::rdx, 0, Reg::rax, 8 });
+        emitter.test64(Reg::rax, Reg::rax);
+        emitter.jcc(Condition::equal, slowPath);
+        emitter.movzxByte(Reg::rdx, Reg::rcx);
+        emitter.storeByte(Mem { Reg::rax, 0, Reg::rdx, 1 }, value);
+        emitter.jmp(done);
+
+        emitter.bind(slowPath);
+        emitter.mov32(argumentRegisters[1], Reg::rcx);
+        emitter.movzxByte(argumentRegisters[2], value);
+        emitter.mov64(argumentRegisters[0], cpuRegister);
+        emitCallOut(reinterpret_cast<const void *>(&CPU::jitMemoryWrite));
+
+        if (codeModified.has_value()) {
+            emitter.cmpByteImm(cachedCodeModifiedField, 0);
+            emitter.jcc(Condition::notEqual, *codeModified);
+        }
+
+        emitter.bind(done);
+    };
+
+    // Leaves the operand value in ecx
+    const auto emitValue = [&](const OpcodeInfo &info, uint16_t operand) {
+        if (info.addressingMode == AddressingMode::immediate) {
+            emitter.movImm32(Reg::rcx, operand & 0xFF);
+        } else {
+            emitAddress(info.addressingMode, operand, info.pageCrossPenalty);
+            emitRead();
+        }
+    };
+
+    const auto emitCompare = [&](Reg reg) {
+        emitter.alu32(AluOp::cmp, reg, Reg::rcx);
+        emitter.setcc(Condition::aboveOrEqual, carryField);
+        emitter.mov32(Reg::rax, reg);
+        emitter.alu32(AluOp::sub, Reg::rax, Reg::rcx);
+        emitter.movzxByte(Reg::rax, Reg::rax);
+        setZN(Reg::rax);
+    };
+
+    // Leaves the stack address in ecx, moving the stack pointer by amount before or after
+    const auto emitStackAddress = [&](int32_t amount, bool before) {
+        emitter.movzxByte(Reg::rcx, spField);
+
+        if (before) {
+            emitter.alu32Imm(AluOp::add, Reg::rcx, amount);
+            emitter.storeByte(spField, Reg::rcx);
+            emitter.movzxByte(Reg::rcx, Reg::rcx);
+        } else {
+            emitter.lea32(Reg::rax, Mem { Reg::rcx, amount });
+            emitter.storeByte(spField, Reg::rax);
+        }
+
+        emitter.alu32Imm(AluOp::bitOr, Reg::rcx, 0x100);
+    };
+
+    const auto emitIncrement = [&](Reg reg, int32_t amount) {
+        emitter.alu32Imm(AluOp::add, reg, amount);
+        emitter.alu32Imm(AluOp::bitAnd, reg, 0xFF);
+        setZN(reg);
+    };
+
+    /* Prologue */
+    emitter.push(Reg::rbx);
+    emitter.push(Reg::rbp);
+    emitter.push(Reg::r12);
+    emitter.push(Reg::r13);
+    emitter.push(Reg::r14);
+    emitter.push(Reg::r15);
+    emitter.alu64Imm(AluOp::sub, Reg::rsp, stackReserve);
+    emitter.mov64(cpuRegister, argumentRegisters[0]);
+    reloadRegisters();
+    emitter.storeByteImm(cachedCodeModifiedField, 0);
+
+    const typename Cache::Instruction *instructions = blockCache->getInstructions(block);
+    uint16_t address = block.address;
+    uint32_t blockCycles = 0;
+    int32_t finalPc = -1;
+
+    for (int i = 0; i < block.instructionCount; i++) {
+        const typename Cache::Instruction &instruction = instructions[i];
+        const OpcodeInfo &info = opcodeTable[instruction.opcode];
+        const uint16_t operand = instruction.operand;
+        const uint16_t nextPc = address + instruction.length;
+        const int executed = i + 1;
+
+        instructionCycleOffset = static_cast<uint16_t>(blockCycles);
+        blockCycles += instruction.cycles;
+        finalPc = nextPc;
+
+        const bool inlineMode = isInlineMode(info.addressingMode);
+        bool generated = true;
+
+        switch (info.operation) {
+            case Operation::LDA: case Operation::LDX: case Operation::LDY: {
+                const Reg reg = info.operation == Operation::LDA ? aRegister
+                              : info.operation == Operation::LDX ? xRegister : yRegister;
+                generated = inlineMode;
+                if (generated) {
+                    emitValue(info, operand);
+                    emitter.mov32(reg, Reg::rcx);
+                    setZN(reg);
+                }
+                break;
+            }
+            case Operation::STA: case Operation::STX: case Operation::STY: {
+                const Reg reg = info.operation == Operation::STA ? aRegister
+                              : info.operation == Operation::STX ? xRegister : yRegister;
+                generated = inlineMode;
+                if (generated) {
+                    emitAddress(info.addressingMode, operand, info.pageCrossPenalty);
+                    emitWrite(reg, addExit(nextPc, blockCycles, executed));
+                }
+                break;
+            }
+            case Operation::AND: case Operation::ORA: case Operation::EOR: {
+                const AluOp aluOp = info.operation == Operation::AND ? AluOp::bitAnd
+                                  : info.operation == Operation::ORA ? AluOp::bitOr : AluOp::bitXor;
+                generated = inlineMode;
+                if (generated) {
+                    emitValue(info, operand);
+                    emitter.alu32(aluOp, aRegister, Reg::rcx);
+                    setZN(aRegister);
+                }
+                break;
+            }
+            case Operation::CMP: case Operation::CPX: case Operation::CPY: {
+                const Reg reg = info.operation == Operation::CMP ? aRegister
+                              : info.operation == Operation::CPX ? xRegister : yRegister;
+                generated = inlineMode;
+                if (generated) {
+                    emitValue(info, operand);
+                    emitCompare(reg);
+                }
+                break;
+            }
+            case Operation::TAX: emitter.mov32(xRegister, aRegister); setZN(xRegister); break;
+            case Operation::TAY: emitter.mov32(yRegister, aRegister); setZN(yRegister); break;
+            case Operation::TXA: emitter.mov32(aRegister, xRegister); setZN(aRegister); break;
+            case Operation::TYA: emitter.mov32(aRegister, yRegister); setZN(aRegister); break;
+            case Operation::INX: emitIncrement(xRegister, 1); break;
+            case Operation::INY: emitIncrement(yRegister, 1); break;
+            case Operation::DEX: emitIncrement(xRegister, -1); break;
+            case Operation::DEY: emitIncrement(yRegister, -1); break;
+            case Operation::CLC: emitter.storeByteImm(carryField, 0); break;
+            case Operation::SEC: emitter.storeByteImm(carryField, 1); break;
+            case Operation::CLV: emitter.storeByteImm(overflowField, 0); break;
+            case Operation::NOP: break;
+            case Operation::BPL: case Operation::BMI: case Operation::BNE: case Operation::BEQ:
+            case Operation::BCC: case Operation::BCS: case Operation::BVC: case Operation::BVS: {
+                const uint16_t destination = nextPc + static_cast<int8_t>(operand & 0xFF);
+                const uint32_t takenCycles = ((nextPc & 0xFF00) != (destination & 0xFF00)) ? 2 : 1;
+                const Label taken = addExit(destination, blockCycles + takenCycles, executed);
+
+                switch (info.operation) {
+                    case Operation::BPL: emitter.test32Imm(negativeRegister, 0x80); emitter.jcc(Condition::equal, taken); break;
+                    case Operation::BMI: emitter.test32Imm(negativeRegister, 0x80); emitter.jcc(Condition::notEqual, taken); break;
+                    case Operation::BNE: emitter.test32(zeroRegister, zeroRegister); emitter.jcc(Condition::notEqual, taken); break;
+                    case Operation::BEQ: emitter.test32(zeroRegister, zeroRegister); emitter.jcc(Condition::equal, taken); break;
+                    case Operation::BCC: emitter.cmpByteImm(carryField, 0); emitter.jcc(Condition::equal, taken); break;
+                    case Operation::BCS: emitter.cmpByteImm(carryField, 0); emitter.jcc(Condition::notEqual, taken); break;
+                    case Operation::BVC: emitter.cmpByteImm(overflowField, 0); emitter.jcc(Condition::equal, taken); break;
+                    default: emitter.cmpByteImm(overflowField, 0); emitter.jcc(Condition::notEqual, taken); break;
+                }
+                break;
+            }
+            case Operation::JMP:
+                generated = info.addressingMode == AddressingMode::absolute;
+                if (generated) {
+                    finalPc = operand;
+                }
+                break;
+            case Operation::JSR: {
+                // Pushes the address of the last byte of the JSR. r9 is caller-saved, so the first write's call
+                // out may clobber it. It is only safe to use again because the low byte is loaded into it afresh.
+                const uint16_t returnAddress = nextPc - 1;
+                emitter.movImm32(Reg::r9, returnAddress >> 8);
+                emitStackAddress(-1, false);
+                emitWrite(Reg::r9, std::nullopt);
+                emitter.movImm32(Reg::r9, returnAddress & 0xFF);
+                emitStackAddress(-1, false);
+                emitWrite(Reg::r9, std::nullopt);
+                finalPc = operand;
+                break;
+            }
+            case Operation::RTS:
+                emitStackAddress(1, true);
+                emitRead();
+                emitter.storeByte(scratchSlot, Reg::rcx);  // The second read may call out and clobber registers
+                emitStackAddress(1, true);
+                emitRead();
+                emitter.shl32Imm(Reg::rcx, 8);
+                emitter.movzxByte(Reg::rax, scratchSlot);
+                emitter.alu32(AluOp::bitOr, Reg::rcx, Reg::rax);
+                emitter.lea32(Reg::rax, Mem { Reg::rcx, 1 });
+                emitter.storeWord(pcField, Reg::rax);
+                finalPc = -1;
+                break;
+            default:
+                generated = false;
+                break;
+        }
+
+        if (!generated) {
+            // Everything else goes through the decoded opcode handler with the state spilled back to the CPU
+            spillRegisters();
+            emitter.storeWordImm(pcField, nextPc);
+            emitter.movImm32(argumentRegisters[1], operand);
+            emitter.mov64(argumentRegisters[0], cpuRegister);
+            emitCallOut(reinterpret_cast<const void *>(instruction.handler));
+            emitter.mov32(Reg::rax, Reg::rax);
+            emitter.add64(cyclesField, Reg::rax);
+            reloadRegisters();
+
+            if (isControlFlow(info.operation)) {
+                finalPc = -1;  // Always the last instruction, and the handler has already set pc
+            } else {
+                emitter.cmpByteImm(cachedCodeModifiedField, 0);
+                emitter.jcc(Condition::notEqual, addExit(-1, blockCycles, executed));
+            }
+        }
+
+        address = nextPc;
+    }
+
+    /* Falling out of the end of the block */
+    if (finalPc >= 0) {
+        emitter.storeWordImm(pcField, static_cast<uint16_t>(finalPc));
+    }
+    emitter.add64Imm(cyclesField, blockCycles);
+    emitter.add64Imm(instructionCountField, block.instructionCount);
+
+    /* Epilogue */
+    emitter.bind(epilogue);
+    spillRegisters();
+    emitter.alu64Imm(AluOp::add, Reg::rsp, stackReserve);
+    emitter.pop(Reg::r15);
+    emitter.pop(Reg::r14);
+    emitter.pop(Reg::r13);
+    emitter.pop(Reg::r12);
+    emitter.pop(Reg::rbp);
+    emitter.pop(Reg::rbx);
+    emitter.ret();
+
+    for (const Exit &exit : exits) {
+        emitter.bind(exit.label);
+        if (exit.pc >= 0) {
+            emitter.storeWordImm(pcField, static_cast<uint16_t>(exit.pc));
+        }
+        emitter.add64Imm(cyclesField, exit.cycles);
+        emitter.add64Imm(instructionCountField, exit.instructions);
+        emitter.jmp(epilogue);
+    }
+
+    const std::size_t codeSize = emitter.finish();
+    jitCode->endWrite(codeSize);
+
+    return codeSize != 0 ? code : nullptr;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+enum class AddressingMode : uint8_t
+{
+    implied,
+    accumulator,
+    immediate,
+    zeroPage,
+    zeroPageX,
+    zeroPageY,
+    absolute,
+    absoluteX,
+    absoluteY,
+    indirect,
+    indexedIndirect,
+    indirectIndexed,
+    relative,
+};
+
+enum class Operation : uint8_t
+{
+    ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI,
+    BNE, BPL, BRK, BVC, BVS, CLC, CLD, CLI,
+    CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR,
+    INC, INX, INY, JMP, JSR, LDA, LDX, LDY,
+    LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL,
+    ROR, RTI, RTS, SBC, SEC, SED, SEI, STA,
+    STX, STY, TAX, TAY, TSX, TXA, TXS, TYA
+};
+
+// Number of operand bytes which follow the opcode
+constexpr int getOperandLength(AddressingMode mode)
+{
+    switch (mode) {
+        case AddressingMode::implied:
+        case AddressingMode::accumulator:
+            return 0;
+        case AddressingMode::absolute:
+        case AddressingMode::absoluteX:
+        case AddressingMode::absoluteY:
+        case AddressingMode::indirect:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+// Instructions which can move the program counter somewhere other than the next instruction
+constexpr bool isControlFlow(Operation operation)
+{
+    switch (operation) {
+        case Operation::BCC: case Operation::BCS: case Operation::BEQ: case Operation::BMI:
+        case Operation::BNE: case Operation::BPL: case Operation::BVC: case Operation::BVS:
+        case Operation::BRK: case Operation::JMP: case Operation::JSR: case Operation::RTI:
+        case Operation::RTS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+struct OpcodeInfo
+{
+    const char *mnemonic;
+    Operation operation;
+    AddressingMode addressingMode;
+    uint8_t cycles;         // Base number of clock cycles
+    bool pageCrossPenalty;  // Takes an extra cycle if the indexed address crosses a page boundary
+};
+
+/**
+ *  Decoding information for every opcode. Instruction handlers are generated from this table at compile time.
+ *  Unofficial opcodes aren't supported yet so they are treated as a 2 cycle NOP to keep the clock moving.
+ *  https://www.nesdev.org/wiki/6502_instructions
+*/
+
+constexpr std::array<OpcodeInfo, 256> opcodeTable = []
+{
+    std::array<OpcodeInfo, 256> table {};
+
+    table.fill({ "???", Operation::NOP, AddressingMode::implied, 2, false });
+
+    table[0x00] = { "BRK", Operation::BRK, AddressingMode::implied, 7, false };
+    table[0x01] = { "ORA", Operation::ORA, AddressingMode::indexedIndirect, 6, false };
+    table[0x05] = { "ORA", Operation::ORA, AddressingMode::zeroPage, 3, false };
+    table[0x06] = { "ASL", Operation::ASL, AddressingMode::zeroPage, 5, false };
+    table[0x08] = { "PHP", Operation::PHP, AddressingMode::implied, 3, false };
+    table[0x09] = { "ORA", Operation::ORA, AddressingMode::immediate, 2, false };
+    table[0x0A] = { "ASL", Operation::ASL, AddressingMode::accumulator, 2, false };
+    table[0x0D] = { "ORA", Operation::ORA, AddressingMode::absolute, 4, false };
+    table[0x0E] = { "ASL", Operation::ASL, AddressingMode::absolute, 6, false };
+
+    table[0x10] = { "BPL", Operation::BPL, AddressingMode::relative, 2, false };
+    table[0x11] = { "ORA", Operation::ORA, AddressingMode::indirectIndexed, 5, true };
+    table[0x15] = { "ORA", Operation::ORA, AddressingMode::zeroPageX, 4, false };
+    table[0x16] = { "ASL", Operation::ASL, AddressingMode::zeroPageX, 6, false };
+    table[0x18] = { "CLC", Operation::CLC, AddressingMode::implied, 2, false };
+    table[0x19] = { "ORA", Operation::ORA, AddressingMode::absoluteY, 4, true };
+    table[0x1D] = { "ORA", Operation::ORA, AddressingMode::absoluteX, 4, true };
+    table[0x1E] = { "ASL", Operation::ASL, AddressingMode::absoluteX, 7, false };
+
+    table[0x20] = { "JSR", Operation::JSR, AddressingMode::absolute, 6, false };
+    table[0x21] = { "AND", Operation::AND, AddressingMode::indexedIndirect, 6, false };
+    table[0x24] = { "BIT", Operation::BIT, AddressingMode::zeroPage, 3, false };
+    table[0x25] = { "AND", Operation::AND, AddressingMode::zeroPage, 3, false };
+    table[0x26] = { "ROL", Operation::ROL, AddressingMode::zeroPage, 5, false };
+    table[0x28] = { "PLP", Operation::PLP, AddressingMode::implied, 4, false };
+    table[0x29] = { "AND", Operation::AND, AddressingMode::immediate, 2, false };
+    table[0x2A] = { "ROL", Operation::ROL, AddressingMode::accumulator, 2, false };
+    table[0x2C] = { "BIT", Operation::BIT, AddressingMode::absolute, 4, false };
+    table[0x2D] = { "AND", Operation::AND, AddressingMode::absolute, 4, false };
+    table[0x2E] = { "ROL", Operation::ROL, AddressingMode::absolute, 6, false };
+
+    table[0x30] = { "BMI", Operation::BMI, AddressingMode::relative, 2, false };
+    table[0x31] = { "AND", Operation::AND, AddressingMode::indirectIndexed, 5, true };
+    table[0x35] = { "AND", Operation::AND, AddressingMode::zeroPageX, 4, false };
+    table[0x36] = { "ROL", Operation::ROL, AddressingMode::zeroPageX, 6, false };
+    table[0x38] = { "SEC", Operation::SEC, AddressingMode::implied, 2, false };
+    table[0x39] = { "AND", Operation::AND, AddressingMode::absoluteY, 4, true };
+    table[0x3D] = { "AND", Operation::AND, AddressingMode::absoluteX, 4, true };
+    table[0x3E] = { "ROL", Operation::ROL, AddressingMode::absoluteX, 7, false };
+
+    table[0x40] = { "RTI", Operation::RTI, AddressingMode::implied, 6, false };
+    table[0x41] = { "EOR", Operation::EOR, AddressingMode::indexedIndirect, 6, false };
+    table[0x45] = { "EOR", Operation::EOR, AddressingMode::zeroPage, 3, false };
+    table[0x46] = { "LSR", Operation::LSR, AddressingMode::zeroPage, 5, false };
+    table[0x48] = { "PHA", Operation::PHA, AddressingMode::implied, 3, false };
+    table[0x49] = { "EOR", Operation::EOR, AddressingMode::immediate, 2, false };
+    table[0x4A] = { "LSR", Operation::LSR, AddressingMode::accumulator, 2, false };
+    table[0x4C] = { "JMP", Operation::JMP, AddressingMode::absolute, 3, false };
+    table[0x4D] = { "EOR", Operation::EOR, AddressingMode::absolute, 4, false };
+    table[0x4E] = { "LSR", Operation::LSR, AddressingMode::absolute, 6, false };
+
+    table[0x50] = { "BVC", Operation::BVC, AddressingMode::relative, 2, false };
+    table[0x51] = { "EOR", Operation::EOR, AddressingMode::indirectIndexed, 5, true };
+    table[0x55] = { "EOR", Operation::EOR, AddressingMode::zeroPageX, 4, false };
+    table[0x56] = { "LSR", Operation::LSR, AddressingMode::zeroPageX, 6, false };
+    table[0x58] = { "CLI", Operation::CLI, AddressingMode::implied, 2, false };
+    table[0x59] = { "EOR", Operation::EOR, AddressingMode::absoluteY, 4, true };
+    table[0x5D] = { "EOR", Operation::EOR, AddressingMode::absoluteX, 4, true };
+    table[0x5E] = { "LSR", Operation::LSR, AddressingMode::absoluteX, 7, false };
+
+    table[0x60] = { "RTS", Operation::RTS, AddressingMode::implied, 6, false };
+    table[0x61] = { "ADC", Operation::ADC, AddressingMode::indexedIndirect, 6, false };
+    table[0x65] = { "ADC", Operation::ADC, AddressingMode::zeroPage, 3, false };
+    table[0x66] = { "ROR", Operation::ROR, AddressingMode::zeroPage, 5, false };
+    table[0x68] = { "PLA", Operation::PLA, AddressingMode::implied, 4, false };
+    table[0x69] = { "ADC", Operation::ADC, AddressingMode::immediate, 2, false };
+    table[0x6A] = { "ROR", Operation::ROR, AddressingMode::accumulator, 2, false };
+    table[0x6C] = { "JMP", Operation::JMP, AddressingMode::indirect, 5, false };
+    table[0x6D] = { "ADC", Operation::ADC, AddressingMode::absolute, 4, false };
+    table[0x6E] = { "ROR", Operation::ROR, AddressingMode::absolute, 6, false };
+
+    table[0x70] = { "BVS", Operation::BVS, AddressingMode::relative, 2, false };
+    table[0x71] = { "ADC", Operation::ADC, AddressingMode::indirectIndexed, 5, true };
+    table[0x75] = { "ADC", Operation::ADC, AddressingMode::zeroPageX, 4, false };
+    table[0x76] = { "ROR", Operation::ROR, AddressingMode::zeroPageX, 6, false };
+    table[0x78] = { "SEI", Operation::SEI, AddressingMode::implied, 2, false };
+    table[0x79] = { "ADC", Operation::ADC, AddressingMode::absoluteY, 4, true };
+    table[0x7D] = { "ADC", Operation::ADC, AddressingMode::absoluteX, 4, true };
+    table[0x7E] = { "ROR", Operation::ROR, AddressingMode::absoluteX, 7, false };
+
+    table[0x81] = { "STA", Operation::STA, AddressingMode::indexedIndirect, 6, false };
+    table[0x84] = { "STY", Operation::STY, AddressingMode::zeroPage, 3, false };
+    table[0x85] = { "STA", Operation::STA, AddressingMode::zeroPage, 3, false };
+    table[0x86] = { "STX", Operation::STX, AddressingMode::zeroPage, 3, false };
+    table[0x88] = { "DEY", Operation::DEY, AddressingMode::implied, 2, false };
+    table[0x8A] = { "TXA", Operation::TXA, AddressingMode::implied, 2, false };
+    table[0x8C] = { "STY", Operation::STY, AddressingMode::absolute, 4, false };
+    table[0x8D] = { "STA", Operation::STA, AddressingMode::absolute, 4, false };
+    table[0x8E] = { "STX", Operation::STX, AddressingMode::absolute, 4, false };
+
+    table[0x90] = { "BCC", Operation::BCC, AddressingMode::relative, 2, false };
+    table[0x91] = { "STA", Operation::STA, AddressingMode::indirectIndexed, 6, false };
+    table[0x94] = { "STY", Operation::STY, AddressingMode::zeroPageX, 4, false };
+    table[0x95] = { "STA", Operation::STA, AddressingMode::zeroPageX, 4, false };
+    table[0x96] = { "STX", Operation::STX, AddressingMode::zeroPageY, 4, false };
+    table[0x98] = { "TYA", Operation::TYA, AddressingMode::implied, 2, false };
+    table[0x99] = { "STA", Operation::STA, AddressingMode::absoluteY, 5, false };
+    table[0x9A] = { "TXS", Operation::TXS, AddressingMode::implied, 2, false };
+    table[0x9D] = { "STA", Operation::STA, AddressingMode::absoluteX, 5, false };
+
+    table[0xA0] = { "LDY", Operation::LDY, AddressingMode::immediate, 2, false };
+    table[0xA1] = { "LDA", Operation::LDA, AddressingMode::indexedIndirect, 6, false };
+    table[0xA2] = { "LDX", Operation::LDX, AddressingMode::immediate, 2, false };
+    table[0xA4] = { "LDY", Operation::LDY, AddressingMode::zeroPage, 3, false };
+    table[0xA5] = { "LDA", Operation::LDA, AddressingMode::zeroPage, 3, false };
+    table[0xA6] = { "LDX", Operation::LDX, AddressingMode::zeroPage, 3, false };
+    table[0xA8] = { "TAY", Operation::TAY, AddressingMode::implied, 2, false };
+    table[0xA9] = { "LDA", Operation::LDA, AddressingMode::immediate, 2, false };
+    table[0xAA] = { "TAX", Operation::TAX, AddressingMode::implied, 2, false };
+    table[0xAC] = { "LDY", Operation::LDY, AddressingMode::absolute, 4, false };
+    table[0xAD] = { "LDA", Operation::LDA, AddressingMode::absolute, 4, false };
+    table[0xAE] = { "LDX", Operation::LDX, AddressingMode::absolute, 4, false };
+
+    table[0xB0] = { "BCS", Operation::BCS, AddressingMode::relative, 2, false };
+    table[0xB1] = { "LDA", Operation::LDA, AddressingMode::indirectIndexed, 5, true };
+    table[0xB4] = { "LDY", Operation::LDY, AddressingMode::zeroPageX, 4, false };
+    table[0xB5] = { "LDA", Operation::LDA, AddressingMode::zeroPageX, 4, false };
+    table[0xB6] = { "LDX", Operation::LDX, AddressingMode::zeroPageY, 4, false };
+    table[0xB8] = { "CLV", Operation::CLV, AddressingMode::implied, 2, false };
+    table[0xB9] = { "LDA", Operation::LDA, AddressingMode::absoluteY, 4, true };
+    table[0xBA] = { "TSX", Operation::TSX, AddressingMode::implied, 2, false };
+    table[0xBC] = { "LDY", Operation::LDY, AddressingMode::absoluteX, 4, true };
+    table[0xBD] = { "LDA", Operation::LDA, AddressingMode::absoluteX, 4, true };
+    table[0xBE] = { "LDX", Operation::LDX, AddressingMode::absoluteY, 4, true };
+
+    table[0xC0] = { "CPY", Operation::CPY, AddressingMode::immediate, 2, false };
+    table[0xC1] = { "CMP", Operation::CMP, AddressingMode::indexedIndirect, 6, false };
+    table[0xC4] = { "CPY", Operation::CPY, AddressingMode::zeroPage, 3, false };
+    table[0xC5] = { "CMP", Operation::CMP, AddressingMode::zeroPage, 3, false };
+    table[0xC6] = { "DEC", Operation::DEC, AddressingMode::zeroPage, 5, false };
+    table[0xC8] = { "INY", Operation::INY, AddressingMode::implied, 2, false };
+    table[0xC9] = { "CMP", Operation::CMP, AddressingMode::immediate, 2, false };
+    table[0xCA] = { "DEX", Operation::DEX, AddressingMode::implied, 2, false };
+    table[0xCC] = { "CPY", Operation::CPY, AddressingMode::absolute, 4, false };
+    table[0xCD] = { "CMP", Operation::CMP, AddressingMode::absolute, 4, false };
+    table[0xCE] = { "DEC", Operation::DEC, AddressingMode::absolute, 6, false };
+
+    table[0xD0] = { "BNE", Operation::BNE, AddressingMode::relative, 2, false };
+    table[0xD1] = { "CMP", Operation::CMP, AddressingMode::indirectIndexed, 5, true };
+    table[0xD5] = { "CMP", Operation::CMP, AddressingMode::zeroPageX, 4, false };
+    table[0xD6] = { "DEC", Operation::DEC, AddressingMode::zeroPageX, 6, false };
+    table[0xD8] = { "CLD", Operation::CLD, AddressingMode::implied, 2, false };
+    table[0xD9] = { "CMP", Operation::CMP, AddressingMode::absoluteY, 4, true };
+    table[0xDD] = { "CMP", Operation::CMP, AddressingMode::absoluteX, 4, true };
+    table[0xDE] = { "DEC", Operation::DEC, AddressingMode::absoluteX, 7, false };
+
+    table[0xE0] = { "CPX", Operation::CPX, AddressingMode::immediate, 2, false };
+    table[0xE1] = { "SBC", Operation::SBC, AddressingMode::indexedIndirect, 6, false };
+    table[0xE4] = { "CPX", Operation::CPX, AddressingMode::zeroPage, 3, false };
+    table[0xE5] = { "SBC", Operation::SBC, AddressingMode::zeroPage, 3, false };
+    table[0xE6] = { "INC", Operation::INC, AddressingMode::zeroPage, 5, false };
+    table[0xE8] = { "INX", Operation::INX, AddressingMode::implied, 2, false };
+    table[0xE9] = { "SBC", Operation::SBC, AddressingMode::immediate, 2, false };
+    table[0xEA] = { "NOP", Operation::NOP, AddressingMode::implied, 2, false };
+    table[0xEC] = { "CPX", Operation::CPX, AddressingMode::absolute, 4, false };
+    table[0xED] = { "SBC", Operation::SBC, AddressingMode::absolute, 4, false };
+    table[0xEE] = { "INC", Operation::INC, AddressingMode::absolute, 6, false };
+
+    table[0xF0] = { "BEQ", Operation::BEQ, AddressingMode::relative, 2, false };
+    table[0xF1] = { "SBC", Operation::SBC, AddressingMode::indirectIndexed, 5, true };
+    table[0xF5] = { "SBC", Operation::SBC, AddressingMode::zeroPageX, 4, false };
+    table[0xF6] = { "INC", Operation::INC, AddressingMode::zeroPageX, 6, false };
+    table[0xF8] = { "SED", Operation::SED, AddressingMode::implied, 2, false };
+    table[0xF9] = { "SBC", Operation::SBC, AddressingMode::absoluteY, 4, true };
+    table[0xFD] = { "SBC", Operation::SBC, AddressingMode::absoluteX, 4, true };
+    table[0xFE] = { "INC", Operation::INC, AddressingMode::absoluteX, 7, false };
+
+    return table;
+}();
@@ -0,0 +1,341 @@
+#include "X64Emitter.h"
+
+#include <cstring>
+
+namespace
+{
+    int encoding(X64Emitter::Reg reg)
+    {
+        return static_cast<int>(reg);
+    }
+
+    // spl, bpl, sil and dil can only be addressed as byte registers with a REX prefix
+    bool needsRexForByte(X64Emitter::Reg reg)
+    {
+        return encoding(reg) >= 4 && encoding(reg) <= 7;
+    }
+}
+
+X64Emitter::X64Emitter(uint8_t *buffer, std::size_t capacity) : buffer(buffer), capacity(capacity)
+{
+}
+
+X64Emitter::Label X64Emitter::newLabel()
+{
+    labelPositions.push_back(0);
+    return static_cast<Label>(labelPositions.size() - 1);
+}
+
+void X64Emitter::bind(Label label)
+{
+    labelPositions[label] = position;
+}
+
+std::size_t X64Emitter::finish()
+{
+    if (position > capacity) {
+        return 0;
+    }
+
+    for (const auto &[fixupPosition, label] : jumpFixups) {
+        const int32_t displacement = static_cast<int32_t>(labelPositions[label] - (fixupPosition + 4));
+        std::memcpy(buffer + fixupPosition, &displacement, sizeof(displacement));
+    }
+
+    return position;
+}
+
+void X64Emitter::emitByte(uint8_t value)
+{
+    // Keep counting past the end so finish() can tell the code didn't fit
+    if (position < capacity) {
+        buffer[position] = value;
+    }
+
+    position++;
+}
+
+void X64Emitter::emit16(uint16_t value)
+{
+    emitByte(value & 0xFF);
+    emitByte(value >> 8);
+}
+
+void X64Emitter::emit32(uint32_t value)
+{
+    emit16(value & 0xFFFF);
+    emit16(value >> 16);
+}
+
+void X64Emitter::emit64(uint64_t value)
+{
+    emit32(value & 0xFFFF'FFFF);
+    emit32(value >> 32);
+}
+
+void X64Emitter::emitRex(bool wide, int reg, int index, int base, bool force)
+{
+    const uint8_t rex = 0x40 | (wide << 3) | (((reg >> 3) & 1) << 2) | (((index >> 3) & 1) << 1) | ((base >> 3) & 1);
+
+    if (rex != 0x40 || force) {
+        emitByte(rex);
+    }
+}
+
+void X64Emitter::emitRexForMem(bool wide, int reg, const Mem &mem, bool force)
+{
+    const int index = mem.index == Reg::none ? 0 : encoding(mem.index);
+    emitRex(wide, reg, index, encoding(mem.base), force);
+}
+
+void X64Emitter::emitModRMRegister(int reg, int rm)
+{
+    emitByte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+void X64Emitter::emitModRMMemory(int reg, const Mem &mem)
+{
+    const int base = encoding(mem.base);
+
+    // Always mod 10 (disp32). A SIB byte is needed for an index, or when the base is rsp/r12.
+    if (mem.index != Reg::none || (base & 7) == 4) {
+        const int index = mem.index == Reg::none ? 4 : encoding(mem.index);
+        const int scaleBits = mem.scale == 8 ? 3 : mem.scale == 4 ? 2 : mem.scale == 2 ? 1 : 0;
+
+        emitByte(0x80 | ((reg & 7) << 3) | 4);
+        emitByte((scaleBits << 6) | ((index & 7) << 3) | (base & 7));
+    } else {
+        emitByte(0x80 | ((reg & 7) << 3) | (base & 7));
+    }
+
+    emit32(static_cast<uint32_t>(mem.displacement));
+}
+
+void X64Emitter::mov32(Reg destination, Reg source)
+{
+    emitRex(false, encoding(source), 0, encoding(destination));
+    emitByte(0x89);
+    emitModRMRegister(encoding(source), encoding(destination));
+}
+
+void X64Emitter::mov64(Reg destination, Reg source)
+{
+    emitRex(true, encoding(source), 0, encoding(destination));
+    emitByte(0x89);
+    emitModRMRegister(encoding(source), encoding(destination));
+}
+
+void X64Emitter::movImm32(Reg destination, uint32_t value)
+{
+    emitRex(false, 0, 0, encoding(destination));
+    emitByte(0xB8 + (encoding(destination) & 7));
+    emit32(value);
+}
+
+void X64Emitter::movImm64(Reg destination, uint64_t value)
+{
+    emitRex(true, 0, 0, encoding(destination));
+    emitByte(0xB8 + (encoding(destination) & 7));
+    emit64(value);
+}
+
+void X64Emitter::movzxByte(Reg destination, Mem source)
+{
+    emitRexForMem(false, encoding(destination), source);
+    emitByte(0x0F);
+    emitByte(0xB6);
+    emitModRMMemory(encoding(destination), source);
+}
+
+void X64Emitter::movzxByte(Reg destination, Reg source)
+{
+    emitRex(false, encoding(destination), 0, encoding(source), needsRexForByte(source));
+    emitByte(0x0F);
+    emitByte(0xB6);
+    emitModRMRegister(encoding(destination), encoding(source));
+}
+
+void X64Emitter::movzxWord(Reg destination, Reg source)
+{
+    emitRex(false, encoding(destination), 0, encoding(source));
+    emitByte(0x0F);
+    emitByte(0xB7);
+    emitModRMRegister(encoding(destination), encoding(source));
+}
+
+void X64Emitter::load64(Reg destination, Mem source)
+{
+    emitRexForMem(true, encoding(destination), source);
+    emitByte(0x8B);
+    emitModRMMemory(encoding(destination), source);
+}
+
+void X64Emitter::storeByte(Mem destination, Reg source)
+{
+    emitRexForMem(false, encoding(source), destination, needsRexForByte(source));
+    emitByte(0x88);
+    emitModRMMemory(encoding(source), destination);
+}
+
+void X64Emitter::storeByteImm(Mem destination, uint8_t value)
+{
+    emitRexForMem(false, 0, destination);
+    emitByte(0xC6);
+    emitModRMMemory(0, destination);
+    emitByte(value);
+}
+
+void X64Emitter::storeWord(Mem destination, Reg source)
+{
+    emitByte(0x66);
+    emitRexForMem(false, encoding(source), destination);
+    emitByte(0x89);
+    emitModRMMemory(encoding(source), destination);
+}
+
+void X64Emitter::storeWordImm(Mem destination, uint16_t value)
+{
+    emitByte(0x66);
+    emitRexForMem(false, 0, destination);
+    emitByte(0xC7);
+    emitModRMMemory(0, destination);
+    emit16(value);
+}
+
+void X64Emitter::lea32(Reg destination, Mem source)
+{
+    emitRexForMem(false, encoding(destination), source);
+    emitByte(0x8D);
+    emitModRMMemory(encoding(destination), source);
+}
+
+void X64Emitter::alu32(AluOp operation, Reg destination, Reg source)
+{
+    emitRex(false, encoding(source), 0, encoding(destination));
+    emitByte((static_cast<uint8_t>(operation) << 3) | 0x01);
+    emitModRMRegister(encoding(source), encoding(destination));
+}
+
+void X64Emitter::alu32Imm(AluOp operation, Reg destination, int32_t value)
+{
+    emitRex(false, 0, 0, encoding(destination));
+    emitByte(0x81);
+    emitModRMRegister(static_cast<int>(operation), encoding(destination));
+    emit32(static_cast<uint32_t>(value));
+}
+
+void X64Emitter::alu64Imm(AluOp operation, Reg destination, int32_t value)
+{
+    emitRex(true, 0, 0, encoding(destination));
+    emitByte(0x81);
+    emitModRMRegister(static_cast<int>(operation), encoding(destination));
+    emit32(static_cast<uint32_t>(value));
+}
+
+void X64Emitter::add64Imm(Mem destination, int32_t value)
+{
+    emitRexForMem(true, 0, destination);
+    emitByte(0x81);
+    emitModRMMemory(0, destination);
+    emit32(static_cast<uint32_t>(value));
+}
+
+void X64Emitter::add64(Mem destination, Reg source)
+{
+    emitRexForMem(true, encoding(source), destination);
+    emitByte(0x01);
+    emitModRMMemory(encoding(source), destination);
+}
+
+void X64Emitter::cmpByteImm(Mem destination, uint8_t value)
+{
+    emitRexForMem(false, 0, destination);
+    emitByte(0x80);
+    emitModRMMemory(7, destination);
+    emitByte(value);
+}
+
+void X64Emitter::shl32Imm(Reg destination, uint8_t count)
+{
+    emitRex(false, 0, 0, encoding(destination));
+    emitByte(0xC1);
+    emitModRMRegister(4, encoding(destination));
+    emitByte(count);
+}
+
+void X64Emitter::shr32Imm(Reg destination, uint8_t count)
+{
+    emitRex(false, 0, 0, encoding(destination));
+    emitByte(0xC1);
+    emitModRMRegister(5, encoding(destination));
+    emitByte(count);
+}
+
+void X64Emitter::test32(Reg first, Reg second)
+{
+    emitRex(false, encoding(second), 0, encoding(first));
+    emitByte(0x85);
+    emitModRMRegister(encoding(second), encoding(first));
+}
+
+void X64Emitter::test32Imm(Reg destination, uint32_t value)
+{
+    emitRex(false, 0, 0, encoding(destination));
+    emitByte(0xF7);
+    emitModRMRegister(0, encoding(destination));
+    emit32(value);
+}
+
+void X64Emitter::test64(Reg first, Reg second)
+{
+    emitRex(true, encoding(second), 0, encoding(first));
+    emitByte(0x85);
+    emitModRMRegister(encoding(second), encoding(first));
+}
+
+void X64Emitter::setcc(Condition condition, Mem destination)
+{
+    emitRexForMem(false, 0, destination);
+    emitByte(0x0F);
+    emitByte(0x90 | static_cast<uint8_t>(condition));
+    emitModRMMemory(0, destination);
+}
+
+void X64Emitter::jcc(Condition condition, Label label)
+{
+    emitByte(0x0F);
+    emitByte(0x80 | static_cast<uint8_t>(condition));
+    jumpFixups.emplace_back(position, label);
+    emit32(0);
+}
+
+void X64Emitter::jmp(Label label)
+{
+    emitByte(0xE9);
+    jumpFixups.emplace_back(position, label);
+    emit32(0);
+}
+
+void X64Emitter::call(const void *function)
+{
+    movImm64(Reg::rax, reinterpret_cast<uint64_t>(function));
+    emitByte(0xFF);
+    emitModRMRegister(2, encoding(Reg::rax));
+}
+
+void X64Emitter::push(Reg reg)
+{
+    emitRex(false, 0, 0, encoding(reg));
+    emitByte(0x50 + (encoding(reg) & 7));
+}
+
+void X64Emitter::pop(Reg reg)
+{
+    emitRex(false, 0, 0, encoding(reg));
+    emitByte(0x58 + (encoding(reg) & 7));
+}
+
+void X64Emitter::ret()
+{
+    emitByte(0xC3);
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define NESBUDDY_JIT_SUPPORTED
+#endif
+
+/**
+ *  Minimal x86-64 assembler used by the JIT backend. Only the handful of instructions the JIT needs are
+ *  supported, and every memory operand is encoded as [base + index * scale + disp32] to keep encoding simple.
+ *  Jumps always use 32-bit displacements and are patched when finish() is called.
+*/
+
+class X64Emitter
+{
+public:
+    enum class Reg : uint8_t
+    {
+        rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi,
+        r8, r9, r10, r11, r12, r13, r14, r15,
+        none = 0xFF
+    };
+
+    enum class Condition : uint8_t
+    {
+        overflow = 0x0,
+        below = 0x2,
+        aboveOrEqual = 0x3,
+        equal = 0x4,
+        notEqual = 0x5,
+        belowOrEqual = 0x6,
+        above = 0x7,
+        sign = 0x8,
+        notSign = 0x9
+    };
+
+    enum class AluOp : uint8_t
+    {
+        add = 0,
+        bitOr = 1,
+        bitAnd = 4,
+        sub = 5,
+        bitXor = 6,
+        cmp = 7
+    };
+
+    struct Mem
+    {
+        Reg base;
+        int32_t displacement {};
+        Reg index { Reg::none };
+        uint8_t scale { 1 };
+    };
+
+    using Label = int;
+
+    X64Emitter(uint8_t *buffer, std::size_t capacity);
+
+    Label newLabel();
+    void bind(Label label);
+
+    // Patches jumps and returns the number of bytes written, or 0 if the code didn't fit in the buffer
+    std::size_t finish();
+
+    /* Moves */
+    void mov32(Reg destination, Reg source);
+    void mov64(Reg destination, Reg source);
+    void movImm32(Reg destination, uint32_t value);
+    void movImm64(Reg destination, uint64_t value);
+    void movzxByte(Reg destination, Mem source);
+    void movzxByte(Reg destination, Reg source);
+    void movzxWord(Reg destination, Reg source);
+    void load64(Reg destination, Mem source);
+    void storeByte(Mem destination, Reg source);
+    void storeByteImm(Mem destination, uint8_t value);
+    void storeWord(Mem destination, Reg source);
+    void storeWordImm(Mem destination, uint16_t value);
+    void lea32(Reg destination, Mem source);
+
+    /* Arithmetic */
+    void alu32(AluOp operation, Reg destination, Reg source);
+    void alu32Imm(AluOp operation, Reg destination, int32_t value);
+    void alu64Imm(AluOp operation, Reg destination, int32_t value);
+    void add64Imm(Mem destination, int32_t value);
+    void add64(Mem destination, Reg source);
+    void cmpByteImm(Mem destination, uint8_t value);
+    void shl32Imm(Reg destination, uint8_t count);
+    void shr32Imm(Reg destination, uint8_t count);
+    void test32(Reg first, Reg second);
+    void test32Imm(Reg destination, uint32_t value);
+    void test64(Reg first, Reg second);
+    void setcc(Condition condition, Mem destination);
+
+    /* Control Flow */
+    void jcc(Condition condition, Label label);
+    void jmp(Label label);
+    void call(const void *function);  // Clobbers rax
+    void push(Reg reg);
+    void pop(Reg reg);
+    void ret();
+
+private:
+    uint8_t *buffer;
+    std::size_t capacity;
+    std::size_t position {};
+
+    std::vector<std::size_t> labelPositions;
+    std::vector<std::pair<std::size_t, Label>> jumpFixups;  // Position of each rel32 and the label it targets
+
+    void emitByte(uint8_t value);
+    void emit16(uint16_t value);
+    void emit32(uint32_t value);
+    void emit64(uint64_t value);
+
+    void emitRex(bool wide, int reg, int index, int base, bool force = false);
+    void emitRexForMem(bool wide, int reg, const Mem &mem, bool force = false);
+    void emitModRMRegister(int reg, int rm);
+    void emitModRMMemory(int reg, const Mem &mem);
+};
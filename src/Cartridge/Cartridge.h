@@ -4,8 +4,11 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <vector>
 
+#include "ROMImage.h"
+
 enum class Nametable
 {
     verticalArrangement,
@@ -24,8 +27,9 @@ typedef struct Cartridge
     int mapperId {};
     Nametable nametable;
     std::optional<std::array<uint8_t, 512>> trainerData {};
-    std::vector<uint8_t> prgROM {};
-    std::vector<uint8_t> chrROM {};
+    std::shared_ptr<const ROMImage> romImage {};  // Shared contents of the .nes file, which prgROM and chrROM point into
+    std::span<const uint8_t> prgROM {};
+    std::span<const uint8_t> chrROM {};
     uint16_t prgROMBanks {};
     uint16_t chrROMBanks {};
     std::vector<uint8_t> prgRAM {};
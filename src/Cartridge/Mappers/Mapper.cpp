@@ -1,7 +1,17 @@
 #include "Mapper.h"
 
 #include "../Cartridge.h"
+#include "../../MemoryMap.h"
 
-Mapper::Mapper(Cartridge &data) : cartridge(data)
+Mapper::Mapper(Cartridge &data, MemoryMap &memoryMap) : cartridge(data), memoryMap(memoryMap)
+{
+}
+
+// Mappers with no registers of their own have nothing to save
+void Mapper::saveState(SaveState::Writer &) const
+{
+}
+
+void Mapper::loadState(SaveState::Reader &)
 {
 }
\ No newline at end of file
@@ -4,16 +4,29 @@
 #include <cstdint>
 #include <vector>
 
+#include "../../SaveState.h"
+
 typedef struct Cartridge Cartridge;
+class MemoryMap;
 
 class Mapper
 {
 public:
-    Mapper(Cartridge &cart);
+    Mapper(Cartridge &cart, MemoryMap &memoryMap);
+
+    // Points the CPU pages controlled by the mapper at the currently selected PRG banks.
+    // Mappers which support bank switching should call this again whenever the banks change.
+    virtual void mapPrgPages() = 0;
 
+    // Used for accesses to pages which aren't directly mapped, such as mapper registers
     virtual uint8_t prgRead(uint16_t address) = 0;
     virtual void prgWrite(uint16_t address, uint8_t value) = 0;
 
+    // Mappers with bank or IRQ registers save them here. mapPrgPages() is called after loading.
+    virtual void saveState(SaveState::Writer &writer) const;
+    virtual void loadState(SaveState::Reader &reader);
+
 protected:
     Cartridge &cartridge;
+    MemoryMap &memoryMap;
 };
\ No newline at end of file
@@ -1,18 +1,42 @@
 #include "Mapper000.h"
 
+#include <algorithm>
+
 #include "../Cartridge.h"
 #include "../../Logger.h"
+#include "../../MemoryMap.h"
 
-Mapper000::Mapper000(Cartridge &data) : Mapper(data)
+Mapper000::Mapper000(Cartridge &data, MemoryMap &memoryMap) : Mapper(data, memoryMap)
 {
 }
 
+// PRG writes are left unmapped so they reach prgWrite() and get reported.
+// PRG-RAM (Family Basic, and most test ROMs) is mapped straight in at $6000, mirrored if it's under 8KB.
+void Mapper000::mapPrgPages()
+{
+    const uint32_t prgRAMSize = std::min<std::size_t>(cartridge.prgRAM.size(), 0x2000);
+
+    if (prgRAMSize >= MemoryMap::pageSize) {
+        for (uint32_t offset = 0; offset + prgRAMSize <= 0x2000; offset += prgRAMSize) {
+            memoryMap.mapRead(0x6000 + offset, prgRAMSize, cartridge.prgRAM.data());
+            memoryMap.mapWrite(0x6000 + offset, prgRAMSize, cartridge.prgRAM.data());
+        }
+    }
+
+    if (cartridge.prgROMBanks == 1) {  // NROM-128 mirrors its single 16KB bank into both halves
+        memoryMap.mapRead(0x8000, 0x4000, cartridge.prgROM.data());
+        memoryMap.mapRead(0xC000, 0x4000, cartridge.prgROM.data());
+    } else {
+        memoryMap.mapRead(0x8000, 0x8000, cartridge.prgROM.data());
+    }
+}
+
 uint8_t Mapper000::prgRead(uint16_t address)
 {
     if (cartridge.prgROMBanks == 1) {
-        return cartridge.prgROM[address];
-    } else {
         return cartridge.prgROM[address & 0x3FFF];
+    } else {
+        return cartridge.prgROM[address];
     }
 }
 
@@ -12,8 +12,9 @@
 class Mapper000 : public Mapper
 {
 public:
-    Mapper000(Cartridge &data);
+    Mapper000(Cartridge &data, MemoryMap &memoryMap);
 
+    void mapPrgPages() override;
     uint8_t prgRead(uint16_t address) override;
     void prgWrite(uint16_t address, uint8_t value) override;
 };
\ No newline at end of file
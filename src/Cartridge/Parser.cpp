@@ -1,5 +1,10 @@
 #include "Parser.h"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
 #include <nfd.hpp>
 
 #include "../Logger.h"
@@ -7,7 +12,7 @@
 
 namespace ROMParser 
 {
-    namespace  // Contains functions which can only be used in openBinaryFile()
+    namespace  // Contains functions which can only be used in openBinaryFile() and loadFromFile()
     {
         // Opens system file dialog for user to select a ROM file
         std::string getFilePath() 
@@ -52,20 +57,17 @@ namespace ROMParser
         }
 
         // Based on file structure specified at https://www.nesdev.org/wiki/INES
-        NESHeader parseiNESHeader(std::array<uint8_t, 16> &headerBytes, std::ifstream &romFile)
+        NESHeader parseiNESHeader(std::array<uint8_t, 16> &headerBytes)
         {
             NESHeader header;
 
             header.prgROMBanks = headerBytes[4];
             header.chrROMBanks = headerBytes[5];
 
-            if (headerBytes[6] & 0x04) {
-                header.prgRAMSize = 8192;
-            }
+            // iNES can't reliably say whether there's PRG-RAM, so every cartridge gets 8KB like on most emulators
+            header.prgRAMSize = 8192;
 
-            if (header.chrROMBanks == 0) {
-                header.chrRAMSize = 8192;
-            }
+            header.chrRAMSize = header.chrROMBanks == 0 ? 8192 : 0;
             
             header.nametable = (headerBytes[6] & 0x01) == 0 
                                 ? Nametable::verticalArrangement 
@@ -92,7 +94,7 @@ namespace ROMParser
         }
 
         // Based on file structure specified at https://www.nesdev.org/wiki/NES_2.0
-        NESHeader parseNES20Header(std::array<uint8_t, 16> &headerBytes, std::ifstream &romFile)
+        NESHeader parseNES20Header(std::array<uint8_t, 16> &headerBytes)
         {
             NESHeader header;
 
@@ -143,7 +145,8 @@ namespace ROMParser
             return header;
         }
 
-        std::optional<Cartridge> readFromNesFile(NESHeader &header, std::ifstream &romFile)
+        // PRG and CHR ROM are left in the mapped file rather than copied out, only RAM gets its own buffers
+        std::optional<Cartridge> readFromNesFile(NESHeader &header, std::shared_ptr<const ROMImage> romImage)
         {
             if (header.targetSystem != SystemType::nes) {
                 Logger::printError("Unsupported console type is specified in ROM file.");
@@ -155,27 +158,45 @@ namespace ROMParser
                 return std::nullopt;
             }
 
-            std::optional<std::array<uint8_t, 512>> trainerData; 
+            if (header.prgROMBanks == 0) {
+                Logger::printError("ROM file has no PRG-ROM.");
+                return std::nullopt;
+            }
+
+            constexpr size_t headerSize = 16;
+            constexpr size_t trainerSize = 512;
+
+            size_t numOfTrainerBytes = header.trainerPresent ? trainerSize : 0;
+            size_t numOfPrgROMBytes = 16384 * header.prgROMBanks;
+            size_t numOfChrROMBytes = 8192 * header.chrROMBanks;
+
+            if (romImage->size() < headerSize + numOfTrainerBytes + numOfPrgROMBytes + numOfChrROMBytes) {
+                Logger::printError("ROM file is smaller than the sizes given in its header.");
+                return std::nullopt;
+            }
+
+            const uint8_t *position = romImage->data() + headerSize;
+
+            std::optional<std::array<uint8_t, 512>> trainerData;
             if (header.trainerPresent) {
                 std::array<uint8_t, 512> trainerDataArray;
-                romFile.read(reinterpret_cast<char*>(trainerDataArray.data()), 512);
+                std::copy_n(position, trainerSize, trainerDataArray.begin());
                 trainerData = trainerDataArray;
+                position += trainerSize;
             } else {
                 trainerData = std::nullopt;
             }
 
-            size_t numOfPrgROMBytes = 16384 * header.prgROMBanks;
-            std::vector<uint8_t> prgROM(numOfPrgROMBytes);
-            romFile.read(reinterpret_cast<char*>(prgROM.data()), numOfPrgROMBytes);
+            std::span<const uint8_t> prgROM(position, numOfPrgROMBytes);
+            position += numOfPrgROMBytes;
 
-            size_t numOfChrROMBytes = 8192 * header.chrROMBanks;
-            std::vector<uint8_t> chrROM(numOfChrROMBytes);
-            romFile.read(reinterpret_cast<char*>(chrROM.data()), numOfChrROMBytes);
+            std::span<const uint8_t> chrROM(position, numOfChrROMBytes);
 
             Cartridge cartridge {
                 header.mapperId,
                 header.nametable,
                 trainerData,
+                std::move(romImage),
                 prgROM,
                 chrROM,
                 header.prgROMBanks,
@@ -194,11 +215,19 @@ namespace ROMParser
         const std::string filepath = ROMParser::getFilePath();
         if (filepath == "") return std::nullopt;
 
-        std::ifstream romFile;
-        romFile.open(filepath, std::ios::binary | std::ios::in);
+        return loadFromFile(filepath);
+    }
 
-        if (!romFile) {
-            Logger::printError("ROM file failed to open: " + filepath);
+    // Loads a ROM from a known path without going through the file dialog.
+    // The cartridge's ROM data points straight into a mapped image shared with any other cartridges with the same contents.
+    std::optional<Cartridge> loadFromFile(const std::string &filepath)
+    {
+        std::shared_ptr<const ROMImage> romImage;
+
+        try {
+            romImage = ROMImage::load(filepath);
+        } catch (const std::runtime_error &error) {
+            Logger::printError(std::string("ROM file failed to open: ") + error.what());
             return std::nullopt;
         }
 
@@ -207,27 +236,28 @@ namespace ROMParser
         constexpr int headerSize = 16;
         std::array<uint8_t, headerSize> headerBytes;
 
-        romFile.read(reinterpret_cast<char*>(headerBytes.data()), headerSize);
-        if (romFile.fail()) {
-                Logger::printError("Failure to read from ROM file: " + filepath);
-                return std::nullopt;
+        if (romImage->size() < headerSize) {
+            Logger::printError("Failure to read from ROM file: " + filepath);
+            return std::nullopt;
         }
 
+        std::memcpy(headerBytes.data(), romImage->data(), headerSize);
+
         FileFormat fileFormat = ROMParser::identifyFileFormat(headerBytes);
 
         NESHeader header;
 
         if (fileFormat == FileFormat::iNES) {
-            header = ROMParser::parseiNESHeader(headerBytes, romFile);
+            header = ROMParser::parseiNESHeader(headerBytes);
         }
         else if (fileFormat == FileFormat::NES20) {
-            header = ROMParser::parseNES20Header(headerBytes, romFile);
+            header = ROMParser::parseNES20Header(headerBytes);
         }
         else if (fileFormat == FileFormat::invalid) {
             Logger::printError("Invalid file format. Please ensure ROM file is a valid .nes file.");
             return std::nullopt;
         }
 
-        return ROMParser::readFromNesFile(header, romFile);
+        return ROMParser::readFromNesFile(header, std::move(romImage));
     }
 }
\ No newline at end of file
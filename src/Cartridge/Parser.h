@@ -1,7 +1,6 @@
 #pragma once
 
 #include <array>
-#include <fstream>
 #include <optional>
 #include <string>
 
@@ -44,4 +43,5 @@ struct NESHeader
 namespace ROMParser 
 {
     std::optional<Cartridge> openBinaryFile();
+    std::optional<Cartridge> loadFromFile(const std::string &filepath);
 }
\ No newline at end of file
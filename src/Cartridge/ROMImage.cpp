@@ -0,0 +1,82 @@
+#include "ROMImage.h"
+
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+    std::mutex registryMutex;
+    std::unordered_multimap<uint64_t, std::weak_ptr<const ROMImage>> registry;
+
+    // Hashes 8 bytes at a time, which keeps hashing a large ROM well under the cost of reading it from disk.
+    // Matching hashes are always confirmed by comparing the contents, so collisions only cost a comparison.
+    uint64_t hashContents(const uint8_t *data, std::size_t size)
+    {
+        constexpr uint64_t multiplier = 0x9E3779B97F4A7C15;
+
+        uint64_t hash = size * multiplier;
+        std::size_t i = 0;
+
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            hash = std::rotl(hash ^ (word * multiplier), 29) * multiplier;
+        }
+
+        for (; i < size; i++) {
+            hash = std::rotl(hash ^ data[i], 29) * multiplier;
+        }
+
+        return hash ^ (hash >> 32);
+    }
+
+    bool hasSameContents(const ROMImage &image, const MappedFile &file)
+    {
+        return image.size() == file.size() && (file.size() == 0 || std::memcmp(image.data(), file.data(), file.size()) == 0);
+    }
+}
+
+ROMImage::ROMImage(MappedFile file, uint64_t hash) : file(std::move(file)), hash(hash)
+{
+}
+
+std::shared_ptr<const ROMImage> ROMImage::load(const std::string &filepath)
+{
+    MappedFile file(filepath);
+    const uint64_t hash = hashContents(file.data(), file.size());
+
+    std::lock_guard lock(registryMutex);
+
+    auto [first, last] = registry.equal_range(hash);
+
+    for (auto it = first; it != last;) {
+        std::shared_ptr<const ROMImage> image = it->second.lock();
+
+        if (image == nullptr) {
+            it = registry.erase(it);  // Every cartridge using it has gone
+        } else if (hasSameContents(*image, file)) {
+            return image;  // The new mapping is dropped in favour of the existing one
+        } else {
+            ++it;
+        }
+    }
+
+    auto image = std::make_shared<const ROMImage>(std::move(file), hash);
+    registry.emplace(hash, image);
+
+    return image;
+}
+
+// The CHR-ROM span is always the same part of the same image, so whichever cartridge gets here first decodes it
+const TileCache &ROMImage::getTileCache(std::span<const uint8_t> chrROM) const
+{
+    std::call_once(tileCacheFlag, [&] {
+        tileCache = std::make_unique<TileCache>();
+        tileCache->update(chrROM);
+    });
+
+    return *tileCache;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+
+#include "../MappedFile.h"
+#include "../PPU/TileCache.h"
+
+/**
+ *  Immutable contents of a .nes file, shared by every cartridge loaded from a file with the same contents.
+ *  Loaded images are registered by a hash of their contents, so running many instances of the same game only
+ *  keeps one copy of its ROM data however many times, or from however many paths, it has been loaded.
+ *  Images are dropped from the registry once the last cartridge using them goes away.
+*/
+
+class ROMImage
+{
+public:
+    // Throws std::runtime_error if the file can't be mapped. Safe to call from several threads at once.
+    static std::shared_ptr<const ROMImage> load(const std::string &filepath);
+
+    const uint8_t *data() const;
+    std::size_t size() const;
+    uint64_t getHash() const;
+
+    // CHR-ROM decoded for the PPU, built by the first cartridge to ask and shared by the rest
+    const TileCache &getTileCache(std::span<const uint8_t> chrROM) const;
+
+    explicit ROMImage(MappedFile file, uint64_t hash);  // Use load(), which shares existing images
+
+private:
+    MappedFile file;
+    uint64_t hash;
+
+    mutable std::once_flag tileCacheFlag;
+    mutable std::unique_ptr<TileCache> tileCache;
+};
+
+inline const uint8_t *ROMImage::data() const
+{
+    return file.data();
+}
+
+inline std::size_t ROMImage::size() const
+{
+    return file.size();
+}
+
+inline uint64_t ROMImage::getHash() const
+{
+    return hash;
+}
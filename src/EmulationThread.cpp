@@ -0,0 +1,42 @@
+#include "EmulationThread.h"
+
+#include <fmt/core.h>
+
+#include "Logger.h"
+
+EmulationThread::EmulationThread(NES &nes, int runAheadFrames)
+    : nes(nes), runAhead(nes, runAheadFrames), pacer(nes.getFrameRate()), thread(&EmulationThread::run, this)
+{
+}
+
+EmulationThread::~EmulationThread()
+{
+    running.store(false, std::memory_order_relaxed);
+    thread.join();
+}
+
+void EmulationThread::run()
+{
+    pacer.setFrameRate(nes.getFrameRate());
+
+    while (running.load(std::memory_order_relaxed)) {
+        while (std::optional<InputEvent> event = inputQueue.pop()) {
+            nes.setControllerButtons(event->port, event->buttons);
+        }
+
+        runAhead.runFrame();
+
+        Frame &frame = frames.getWriteBuffer();
+        frame.pixels = nes.getFrameBuffer();
+        frame.number = nes.getFrameCount();
+        frames.publish();
+
+        pacer.waitForNextFrame();
+    }
+
+    const FramePacer::Statistics statistics = pacer.getStatistics();
+
+    Logger::printInfo(fmt::format("Frame pacing: {} frames at {:.1f} us, mean {:.1f} us, jitter {:.1f} us, worst {:.1f} us off, {} resyncs",
+                                  statistics.frames, statistics.targetMicroseconds, statistics.meanMicroseconds,
+                                  statistics.jitterMicroseconds, statistics.maxErrorMicroseconds, statistics.droppedDeadlines));
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "FramePacer.h"
+#include "NES.h"
+#include "RunAhead.h"
+#include "SPSCQueue.h"
+#include "TripleBuffer.h"
+
+// Finished frame handed from the emulation thread to the render thread
+struct Frame
+{
+    NES::FrameBuffer pixels;
+    uint64_t number;  // Frame count of the console when it was generated
+};
+
+// Controller state change sent from the render thread to the emulation thread
+struct InputEvent
+{
+    uint8_t port;
+    uint8_t buttons;  // Bit per Button, as taken by NES::setControllerButtons
+};
+
+/**
+ *  Runs the console on its own thread at its own frame rate, so a slow present on the render thread never
+ *  holds back emulated time and a slow frame never holds back presenting. Frames go out through a triple
+ *  buffer and input comes in through a queue, so neither thread ever waits on a lock held by the other.
+ *  Frames are paced to the refresh rate of the cartridge's region, and the pacing statistics are logged when
+ *  the thread stops. The NES is only touched by the emulation thread between construction and destruction.
+*/
+
+class EmulationThread
+{
+public:
+    EmulationThread(NES &nes, int runAheadFrames);  // Starts running straight away
+    ~EmulationThread();                             // Stops and waits for the thread to finish
+
+    EmulationThread(const EmulationThread &) = delete;
+    EmulationThread &operator=(const EmulationThread &) = delete;
+
+    bool pushInput(const InputEvent &event);  // Fails if the emulation thread is too far behind to take it
+
+    // Returns nullptr if no frame has finished since the last call, otherwise the newest one, which stays
+    // valid until the next call. Only the render thread may call this.
+    const Frame *takeFrame();
+
+private:
+    NES &nes;
+    RunAhead runAhead;
+    FramePacer pacer;
+
+    TripleBuffer<Frame> frames;
+    SPSCQueue<InputEvent, 64> inputQueue;
+
+    std::atomic<bool> running { true };
+    std::thread thread;  // Declared last so everything it uses exists before it starts
+
+    void run();
+};
+
+inline bool EmulationThread::pushInput(const InputEvent &event)
+{
+    return inputQueue.push(event);
+}
+
+inline const Frame *EmulationThread::takeFrame()
+{
+    return frames.consume();
+}
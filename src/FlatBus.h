@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "MemoryMap.h"
+
+/**
+ *  Bus with 64KB of flat RAM and nothing else mapped in.
+ *  This class is intended to be used for running the CPU in isolation such as in tests and benchmarks.
+ *  Not to be used for actual NES emulation.
+ *
+ *  Pages are only mapped for writing once they have been written to, so the first write to each page goes
+ *  through memoryWrite() (the JIT falls back to it for unmapped pages) and is recorded in a dirty list. reset()
+ *  then only has to clear those pages, which lets one bus be reused for millions of short test runs.
+*/
+
+class FlatBus
+{
+public:
+    FlatBus();
+
+    uint8_t memoryRead(uint16_t address);
+    void memoryWrite(uint16_t address, uint8_t value);
+    const uint8_t *getCodePointer(uint16_t address);
+    const MemoryMap &getMemoryMap();
+
+    void reset();  // Zeroes every page written since the last reset
+
+    // Copying would leave the memory map pointing at the original's memory
+    FlatBus(const FlatBus &) = delete;
+    FlatBus &operator=(const FlatBus &) = delete;
+
+private:
+    std::array<uint8_t, 64 * 1024> memory {};
+    MemoryMap memoryMap;  // Every page maps straight onto memory for reads, but only dirty pages for writes
+
+    std::array<uint8_t, MemoryMap::pageCount> dirtyPages {};
+    int dirtyPageCount {};
+
+    void markPageDirty(uint16_t address);
+};
+
+inline FlatBus::FlatBus()
+{
+    memoryMap.mapRead(0x0000, 0x10000, memory.data());
+}
+
+inline uint8_t FlatBus::memoryRead(uint16_t address)
+{
+    return memory[address];
+}
+
+inline void FlatBus::memoryWrite(uint16_t address, uint8_t value)
+{
+    if (memoryMap.getWritePage(address) == nullptr) {
+        markPageDirty(address);
+    }
+
+    memory[address] = value;
+}
+
+inline void FlatBus::markPageDirty(uint16_t address)
+{
+    const uint16_t pageStart = address & 0xFF00;
+
+    dirtyPages[dirtyPageCount++] = static_cast<uint8_t>(pageStart >> 8);
+    memoryMap.mapWrite(pageStart, MemoryMap::pageSize, memory.data() + pageStart);
+}
+
+inline void FlatBus::reset()
+{
+    for (int i = 0; i < dirtyPageCount; i++) {
+        const uint16_t pageStart = dirtyPages[i] << 8;
+
+        std::fill_n(memory.data() + pageStart, MemoryMap::pageSize, 0);
+        memoryMap.unmapWrite(pageStart, MemoryMap::pageSize);
+    }
+
+    dirtyPageCount = 0;
+}
+
+
+inline const uint8_t *FlatBus::getCodePointer(uint16_t address)
+{
+    return &memory[address];
+}
+
+inline const MemoryMap &FlatBus::getMemoryMap()
+{
+    return memoryMap;
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#if defined(__linux__)
+    #include <cerrno>
+    #include <time.h>
+#endif
+
+namespace
+{
+    // How long before the deadline sleeping hands over to spinning. Covers the usual timer slack and wakeup
+    // latency without spending much of the frame spinning.
+    constexpr int64_t spinNanoseconds = 500'000;
+
+    constexpr int64_t maxFramesBehind = 3;
+}
+
+FramePacer::FramePacer(double frameRate)
+{
+    setFrameRate(frameRate);
+}
+
+void FramePacer::setFrameRate(double frameRate)
+{
+    frameNanoseconds = static_cast<int64_t>(1e9 / frameRate);
+    deadline = now() + frameNanoseconds;
+    lastWake = 0;
+}
+
+void FramePacer::waitForNextFrame()
+{
+    const int64_t current = now();
+
+    if (current - deadline > maxFramesBehind * frameNanoseconds) {
+        deadline = current + frameNanoseconds;
+        lastWake = 0;  // The interval across a restart says nothing about the pacing
+        droppedDeadlines++;
+    }
+
+    if (deadline - current > spinNanoseconds) {
+        sleepUntil(deadline - spinNanoseconds);
+    }
+
+    int64_t wake = now();
+    while (wake < deadline) {
+        wake = now();
+    }
+
+    if (lastWake != 0) {
+        recordInterval(wake - lastWake);
+    }
+
+    lastWake = wake;
+    deadline += frameNanoseconds;
+}
+
+// Welford's running mean and variance, so nothing has to be kept per frame
+void FramePacer::recordInterval(int64_t nanoseconds)
+{
+    const double interval = static_cast<double>(nanoseconds);
+
+    intervalCount++;
+    const double delta = interval - intervalMean;
+    intervalMean += delta / intervalCount;
+    intervalSquaredDeviations += delta * (interval - intervalMean);
+
+    maxIntervalError = std::max(maxIntervalError, std::abs(interval - frameNanoseconds));
+}
+
+FramePacer::Statistics FramePacer::getStatistics() const
+{
+    const double variance = intervalCount > 1 ? intervalSquaredDeviations / (intervalCount - 1) : 0.0;
+
+    return Statistics {
+        intervalCount,
+        droppedDeadlines,
+        frameNanoseconds / 1e3,
+        intervalMean / 1e3,
+        std::sqrt(variance) / 1e3,
+        maxIntervalError / 1e3
+    };
+}
+
+void FramePacer::resetStatistics()
+{
+    intervalCount = 0;
+    droppedDeadlines = 0;
+    intervalMean = 0.0;
+    intervalSquaredDeviations = 0.0;
+    maxIntervalError = 0.0;
+    lastWake = 0;
+}
+
+int64_t FramePacer::now()
+{
+#if defined(__linux__)
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<int64_t>(time.tv_sec) * 1'000'000'000 + time.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// An absolute deadline can't be pushed back by the thread being descheduled between reading the clock and sleeping
+void FramePacer::sleepUntil(int64_t time)
+{
+#if defined(__linux__)
+    const timespec target { static_cast<time_t>(time / 1'000'000'000), static_cast<long>(time % 1'000'000'000) };
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {
+    }
+#else
+    const auto sinceEpoch = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(time));
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(sinceEpoch));
+#endif
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ *  Holds a loop to a fixed frame rate against absolute deadlines, so time spent on each frame doesn't add up
+ *  as drift. Waiting sleeps until shortly before the deadline, which is where the OS is free to wake late, and
+ *  spins through the rest. Falling several frames behind gives up on catching up and starts again from now.
+ *  Keeps statistics of the time between frames to show how steady the pacing is.
+*/
+
+class FramePacer
+{
+public:
+    struct Statistics
+    {
+        uint64_t frames;              // Frame intervals measured
+        uint64_t droppedDeadlines;    // Times pacing fell too far behind and restarted
+        double targetMicroseconds;
+        double meanMicroseconds;
+        double jitterMicroseconds;    // Standard deviation of the interval
+        double maxErrorMicroseconds;  // Furthest any interval was from the target
+    };
+
+    explicit FramePacer(double frameRate);
+
+    void setFrameRate(double frameRate);  // Also restarts pacing from now
+    void waitForNextFrame();
+
+    Statistics getStatistics() const;
+    void resetStatistics();
+
+private:
+    int64_t frameNanoseconds;
+    int64_t deadline;   // Steady clock time in nanoseconds the next frame starts at
+    int64_t lastWake {};
+
+    uint64_t intervalCount {};
+    uint64_t droppedDeadlines {};
+    double intervalMean {};
+    double intervalSquaredDeviations {};  // Running sum for the variance
+    double maxIntervalError {};
+
+    void recordInterval(int64_t nanoseconds);
+
+    static int64_t now();
+    static void sleepUntil(int64_t time);
+};
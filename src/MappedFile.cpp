@@ -0,0 +1,127 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string &filepath)
+{
+#if defined(_WIN32)
+    fileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        throw std::runtime_error("Failed to open file: " + filepath);
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        close();
+        throw std::runtime_error("Failed to get size of file: " + filepath);
+    }
+
+    mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+
+    // Empty files can't be mapped, they're left as a null view with a size of 0
+    if (mappedSize != 0) {
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        mappedData = mappingHandle != nullptr
+                   ? static_cast<const uint8_t *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0))
+                   : nullptr;
+
+        if (mappedData == nullptr) {
+            close();
+            throw std::runtime_error("Failed to map file: " + filepath);
+        }
+    }
+#else
+    const int fileDescriptor = open(filepath.c_str(), O_RDONLY);
+
+    if (fileDescriptor == -1) {
+        throw std::runtime_error("Failed to open file: " + filepath);
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) == -1) {
+        ::close(fileDescriptor);
+        throw std::runtime_error("Failed to get size of file: " + filepath);
+    }
+
+    mappedSize = static_cast<std::size_t>(fileStatus.st_size);
+
+    // Empty files can't be mapped, they're left as a null view with a size of 0
+    if (mappedSize != 0) {
+        void *mapping = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        mappedData = mapping != MAP_FAILED ? static_cast<const uint8_t *>(mapping) : nullptr;
+    }
+
+    // The mapping keeps its own reference to the file
+    ::close(fileDescriptor);
+
+    if (mappedSize != 0 && mappedData == nullptr) {
+        mappedSize = 0;
+        throw std::runtime_error("Failed to map file: " + filepath);
+    }
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other) {
+        close();
+
+        mappedData = std::exchange(other.mappedData, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+#if defined(_WIN32)
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+
+    return *this;
+}
+
+void MappedFile::close()
+{
+#if defined(_WIN32)
+    if (mappedData != nullptr) {
+        UnmapViewOfFile(mappedData);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != nullptr) {
+        CloseHandle(fileHandle);
+    }
+
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    if (mappedData != nullptr) {
+        munmap(const_cast<uint8_t *>(mappedData), mappedSize);
+    }
+#endif
+
+    mappedData = nullptr;
+    mappedSize = 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ *  Read-only view of a whole file mapped into memory, so large files can be read in place without
+ *  copying them into buffers first. The mapping lives as long as the object does.
+*/
+
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &filepath);  // Throws std::runtime_error if the file can't be mapped
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const uint8_t *data() const;
+    std::size_t size() const;
+
+private:
+    const uint8_t *mappedData { nullptr };
+    std::size_t mappedSize {};
+
+#if defined(_WIN32)
+    void *fileHandle { nullptr };
+    void *mappingHandle { nullptr };
+#endif
+
+    void close();
+};
+
+inline const uint8_t *MappedFile::data() const
+{
+    return mappedData;
+}
+
+inline std::size_t MappedFile::size() const
+{
+    return mappedSize;
+}
@@ -0,0 +1,38 @@
+#include "MemoryMap.h"
+
+// Addresses and sizes must be multiples of the page size
+void MemoryMap::mapRead(uint16_t startAddress, uint32_t size, const uint8_t *data)
+{
+    const int firstPage = startAddress / pageSize;
+
+    for (uint32_t i = 0; i < size / pageSize; i++) {
+        readPages[firstPage + i] = data + (i * pageSize);
+    }
+}
+
+void MemoryMap::mapWrite(uint16_t startAddress, uint32_t size, uint8_t *data)
+{
+    const int firstPage = startAddress / pageSize;
+
+    for (uint32_t i = 0; i < size / pageSize; i++) {
+        writePages[firstPage + i] = data + (i * pageSize);
+    }
+}
+
+void MemoryMap::unmapRead(uint16_t startAddress, uint32_t size)
+{
+    const int firstPage = startAddress / pageSize;
+
+    for (uint32_t i = 0; i < size / pageSize; i++) {
+        readPages[firstPage + i] = nullptr;
+    }
+}
+
+void MemoryMap::unmapWrite(uint16_t startAddress, uint32_t size)
+{
+    const int firstPage = startAddress / pageSize;
+
+    for (uint32_t i = 0; i < size / pageSize; i++) {
+        writePages[firstPage + i] = nullptr;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/**
+ *  Page table for the CPU address space. Each 256 byte page points directly at the host memory backing it
+ *  so ordinary reads and writes are a single load. Pages left as nullptr need side effects (I/O and mapper
+ *  registers) and are handled by the slow path of the owning bus.
+*/
+
+class MemoryMap
+{
+public:
+    static constexpr int pageSize = 256;
+    static constexpr int pageCount = 256;
+
+    void mapRead(uint16_t startAddress, uint32_t size, const uint8_t *data);
+    void mapWrite(uint16_t startAddress, uint32_t size, uint8_t *data);
+    void unmapRead(uint16_t startAddress, uint32_t size);
+    void unmapWrite(uint16_t startAddress, uint32_t size);
+
+    const uint8_t *getReadPage(uint16_t address) const;
+    uint8_t *getWritePage(uint16_t address) const;
+
+    // Raw page tables, for generated code which does its own lookups
+    const uint8_t *const *getReadPageTable() const;
+    uint8_t *const *getWritePageTable() const;
+
+private:
+    std::array<const uint8_t *, pageCount> readPages {};
+    std::array<uint8_t *, pageCount> writePages {};
+};
+
+inline const uint8_t *MemoryMap::getReadPage(uint16_t address) const
+{
+    return readPages[address >> 8];
+}
+
+inline uint8_t *MemoryMap::getWritePage(uint16_t address) const
+{
+    return writePages[address >> 8];
+}
+
+inline const uint8_t *const *MemoryMap::getReadPageTable() const
+{
+    return readPages.data();
+}
+
+inline uint8_t *const *MemoryMap::getWritePageTable() const
+{
+    return writePages.data();
+}
\ No newline at end of file
@@ -1,14 +1,56 @@
 #include "NES.h"
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <optional>
 #include <stdexcept>
+#include <utility>
 
 #include "Cartridge/Parser.h"
 #include "Cartridge/Mappers/Mapper.h"
 #include "Cartridge/Mappers/Mapper000.h"
-#include "Cartridge/Mappers/NoMapper.h"
 #include "CPU/State.h"
 #include "Logger.h"
 
+namespace
+{
+    // Returns the CPU cycle at which the given frame finishes.
+    // NTSC frames are 341x262 PPU dots at 3 dots per CPU cycle, PAL frames are 341x312 dots at 3.2 dots per CPU cycle.
+    uint64_t getFrameEndCycle(uint64_t frame, Region region)
+    {
+        if (region == Region::pal) {
+            return frame * 341 * 312 * 5 / 16;
+        } else {
+            return frame * 341 * 262 / 3;
+        }
+    }
+
+    // Returns the CPU cycle at which the given frame enters vblank, at dot 1 of scanline 241
+    uint64_t getVblankCycle(uint64_t frame, Region region)
+    {
+        constexpr uint64_t vblankDot = 241 * 341 + 1;
+
+        if (region == Region::pal) {
+            return (frame * 341 * 312 + vblankDot) * 5 / 16;
+        } else {
+            return (frame * 341 * 262 + vblankDot) / 3;
+        }
+    }
+
+    // Returns the CPU cycle at which the given frame leaves vblank, at dot 1 of the pre-render scanline
+    uint64_t getVblankEndCycle(uint64_t frame, Region region)
+    {
+        if (region == Region::pal) {
+            return (frame * 341 * 312 + 311 * 341 + 1) * 5 / 16;
+        } else {
+            return (frame * 341 * 262 + 261 * 341 + 1) / 3;
+        }
+    }
+
+    constexpr uint16_t ramSize = 0x800;
+}
+
 NES::NES()
 {
     std::optional<Cartridge> cart;
@@ -22,55 +64,418 @@ NES::NES()
         }
     }
 
-    this->cartridge = cart.value();
+    insertCartridge(std::move(cart.value()));
+}
+
+NES::NES(const std::string &romPath)
+{
+    std::optional<Cartridge> cart = ROMParser::loadFromFile(romPath);
+
+    if (!cart.has_value()) {
+        throw std::runtime_error("Failed to load ROM file: " + romPath);
+    }
+
+    insertCartridge(std::move(cart.value()));
+}
+
+// Sets up the mapper and memory map for the cartridge and powers up the CPU. Throws if the mapper isn't supported.
+void NES::insertCartridge(Cartridge newCartridge)
+{
+    cartridge = std::move(newCartridge);
 
     switch (cartridge.mapperId) {
         case 0:
-            mapper = std::make_unique<Mapper000>(cartridge);
+            mapper = std::make_unique<Mapper000>(cartridge, memoryMap);
             break;
         default:
-            Logger::printError("Unrecognised/unsupported mapper number in cartridge.");
-            mapper = nullptr;
-            break;
+            throw std::runtime_error("Unrecognised/unsupported mapper number in cartridge: "
+                                     + std::to_string(cartridge.mapperId));
+    }
+
+    // PPU and APU/IO registers are left unmapped, so they go through the slow path
+    for (uint16_t mirror = 0x0000; mirror < 0x2000; mirror += ramSize) {
+        memoryMap.mapRead(mirror, ramSize, ram.data());
+        memoryMap.mapWrite(mirror, ramSize, ram.data());
     }
 
-    cpu.connectToNes(this);
-    cpu.setToPowerUpState();
+    mapper->mapPrgPages();
+
+    cpu.connectToBus(this);
+    reset();
+
+    // Measured by writing a state into an empty buffer
+    SaveState::Writer sizeCounter({});
+    writeState(sizeCounter);
+    saveStateSize = sizeCounter.getSize();
 }
 
-NES::NES(CPUState &initialState) : cpu(initialState)
+// Power cycles the console with the same cartridge still inserted. Nothing is reallocated, so this is cheap
+// enough for workloads which restart the machine constantly.
+void NES::reset()
 {
-    Cartridge cart {};
-    cart.prgROM = std::vector<uint8_t>(1024 * 32);
-    cart.prgROMBanks = 1;
+    ram.fill(0);
+
+    frameCount = 0;
+    irqSources = 0;
 
-    cartridge = cart;
-    mapper = std::make_unique<NoMapper>(cartridge);
+    ppu.reset();
+    apuRegisters.fill(0);
+    controllerShifters.fill(0);
+    controllerStrobe = false;
 
-    cpu.connectToNes(this);
+    cpu.reset();
+
+    scheduler.clear();
+    vblankFrame = 0;
+    scheduler.schedule(ScheduledEvent::vblank, getVblankCycle(vblankFrame, cartridge.region));
 }
 
-uint8_t NES::memoryRead(uint16_t address)
+// Handles accesses to pages which aren't directly mapped in the memory map.
+// Reads from nothing return the high byte of the address, which is usually what was last left on the data bus.
+uint8_t NES::memoryReadSlow(uint16_t address)
 {
-    if (address >= 0x0 && address <= 0x7FFF) {
-        return memory[address];
-    } else {
+    if (address < 0x2000) {
+        return ram[address % ramSize];
+    } else if (address < 0x4000) {
+        return readPPURegister(address);
+    } else if (address < 0x4020) {
+        return readIORegister(address);
+    } else if (address >= 0x8000) {
         return mapper->prgRead(address - 0x8000);
+    } else {
+        return address >> 8;
     }
 }
 
-void NES::memoryWrite(uint16_t address, uint8_t value)
+void NES::memoryWriteSlow(uint16_t address, uint8_t value)
 {
-    if (address >= 0x0 && address <= 0x7FFF) {
-        memory[address] = value;
-    } else {
+    if (address < 0x2000) {
+        ram[address % ramSize] = value;
+    } else if (address < 0x4000) {
+        writePPURegister(address, value);
+    } else if (address < 0x4020) {
+        writeIORegister(address, value);
+    } else if (address >= 0x8000) {
         mapper->prgWrite(address - 0x8000, value);
     }
 }
 
-void NES::tickCPU()
+// Register accesses are timed from the start of the instruction making them
+uint8_t NES::readPPURegister(uint16_t address)
+{
+    return ppu.readRegister(address, cpu.getCurrentCycle());
+}
+
+void NES::writePPURegister(uint16_t address, uint8_t value)
+{
+    const bool nmiWasEnabled = ppu.isNMIEnabled();
+
+    ppu.writeRegister(address, value, cpu.getCurrentCycle());
+
+    // Turning NMI on part way through vblank raises it straight away
+    if (!nmiWasEnabled && ppu.isNMIEnabled() && ppu.isInVblank()) {
+        cpu.triggerNMI();
+    }
+}
+
+// APU and I/O registers at $4000-$401F
+uint8_t NES::readIORegister(uint16_t address)
+{
+    switch (address) {
+        case 0x4015: {  // APU status, reading it acknowledges the frame interrupt
+            const uint8_t frameIrqMask = 1 << static_cast<int>(ScheduledEvent::apuFrameIrq);
+            const uint8_t status = (irqSources & frameIrqMask) ? 0x40 : 0x00;
+            setIRQSource(ScheduledEvent::apuFrameIrq, false);
+            return status;
+        }
+        case 0x4016:
+        case 0x4017: {  // Controllers shift out one button per read, then report 1s once all 8 are read
+            const int port = address - 0x4016;
+            uint8_t bit;
+
+            if (controllerStrobe) {
+                bit = controllerButtons[port] & 0x01;
+            } else {
+                bit = controllerShifters[port] & 0x01;
+                controllerShifters[port] = (controllerShifters[port] >> 1) | 0x80;
+            }
+
+            return 0x40 | bit;  // Upper bits are left over from the address on the data bus
+        }
+        default:
+            return address >> 8;
+    }
+}
+
+void NES::writeIORegister(uint16_t address, uint8_t value)
+{
+    switch (address) {
+        case 0x4014: {  // OAMDMA, copies a whole page into sprite memory. The CPU stall isn't modelled yet.
+            std::array<uint8_t, 256> page;
+            for (int i = 0; i < 256; i++) {
+                page[i] = memoryRead((value << 8) | i);
+            }
+            ppu.writeOAMDMA(page, cpu.getCurrentCycle());
+            break;
+        }
+        case 0x4016:  // Controller strobe, the buttons are latched for as long as it's held high
+            controllerStrobe = value & 0x01;
+            if (controllerStrobe) {
+                controllerShifters = controllerButtons;
+            }
+            break;
+        case 0x4017:  // APU frame counter, setting the inhibit flag also clears a pending frame interrupt
+            apuRegisters[address - 0x4000] = value;
+            if (value & 0x40) {
+                setIRQSource(ScheduledEvent::apuFrameIrq, false);
+            }
+            break;
+        default:
+            if (address < 0x4000 + apuRegisters.size()) {
+                apuRegisters[address - 0x4000] = value;
+            }
+            break;
+    }
+}
+
+void NES::setControllerButtons(int port, uint8_t buttons)
+{
+    controllerButtons[port] = buttons;
+
+    if (controllerStrobe) {
+        controllerShifters[port] = buttons;
+    }
+}
+
+int NES::tickCPU()
+{
+    return cpu.tick();
+}
+
+// Runs the CPU for at least the given number of cycles and returns the number of cycles actually run.
+// May overshoot the budget by up to one instruction.
+uint64_t NES::runCycles(uint64_t cycleBudget)
+{
+    const uint64_t startCycle = cpu.getCycleCount();
+    runUntil(startCycle + cycleBudget);
+    return cpu.getCycleCount() - startCycle;
+}
+
+// Runs the CPU until the next frame boundary
+void NES::runFrame()
+{
+    // Frames which already finished during runCycles() are counted but not run again
+    while (getFrameEndCycle(frameCount + 1, cartridge.region) <= cpu.getCycleCount()) {
+        frameCount++;
+    }
+
+    runUntil(getFrameEndCycle(frameCount + 1, cartridge.region));
+    frameCount++;
+}
+
+// Runs the CPU in stretches up to each scheduled event, handling events as they fall due
+void NES::runUntil(uint64_t targetCycle)
+{
+    while (cpu.getCycleCount() < targetCycle) {
+        cpu.runUntil(std::min(targetCycle, scheduler.getNextEventCycle()));
+
+        while (std::optional<ScheduledEvent> event = scheduler.popDueEvent(cpu.getCycleCount())) {
+            handleEvent(*event);
+        }
+    }
+}
+
+void NES::handleEvent(ScheduledEvent event)
+{
+    switch (event) {
+        case ScheduledEvent::vblank:
+            ppu.startVblank(cpu.getCycleCount());
+            if (ppu.isNMIEnabled()) {
+                cpu.triggerNMI();
+            }
+            scheduler.schedule(ScheduledEvent::vblankEnd, getVblankEndCycle(vblankFrame, cartridge.region));
+            vblankFrame++;
+            scheduler.schedule(ScheduledEvent::vblank, getVblankCycle(vblankFrame, cartridge.region));
+            break;
+        case ScheduledEvent::vblankEnd:
+            ppu.endVblank(cpu.getCycleCount());
+            break;
+        case ScheduledEvent::apuFrameIrq:
+        case ScheduledEvent::mapperIrq:
+            // Stays asserted until the source is acknowledged through its registers
+            setIRQSource(event, true);
+            break;
+        default:
+            break;
+    }
+}
+
+// The IRQ line is shared, so it stays asserted while any source is still asserting it
+void NES::setIRQSource(ScheduledEvent source, bool asserted)
+{
+    const uint8_t mask = 1 << static_cast<int>(source);
+
+    if (asserted) {
+        irqSources |= mask;
+    } else {
+        irqSources &= ~mask;
+    }
+
+    cpu.setIRQLine(irqSources != 0);
+}
+
+// Switches the CPU between the plain interpreter and the cached interpreter
+void NES::setBlockCacheEnabled(bool enabled)
+{
+    cpu.setBlockCacheEnabled(enabled);
+}
+
+// Switches the CPU to the JIT backend, which also enables the block cache it is built on
+void NES::setJITEnabled(bool enabled)
+{
+    cpu.setJITEnabled(enabled);
+}
+
+std::size_t NES::getSaveStateSize()
+{
+    return saveStateSize;
+}
+
+bool NES::saveState(std::span<uint8_t> buffer)
+{
+    if (buffer.size() < saveStateSize) {
+        Logger::printError("Savestate buffer is too small.");
+        return false;
+    }
+
+    SaveState::Writer writer(buffer);
+    writeState(writer);
+    return true;
+}
+
+bool NES::loadState(std::span<const uint8_t> buffer)
+{
+    const SaveState::Header expected = makeSaveStateHeader();
+    SaveState::Header header;
+
+    if (buffer.size() < sizeof(header)) {
+        Logger::printError("Savestate is too small to be valid.");
+        return false;
+    }
+
+    std::memcpy(&header, buffer.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version) {
+        Logger::printError("Savestate isn't in the format used by this version.");
+        return false;
+    }
+
+    if (header.romHash != expected.romHash || header.size != expected.size || buffer.size() < header.size) {
+        Logger::printError("Savestate was saved from a different cartridge.");
+        return false;
+    }
+
+    SaveState::Reader reader(buffer);
+    readState(reader);
+    return true;
+}
+
+SaveState::Header NES::makeSaveStateHeader()
+{
+    SaveState::Header header {};
+    std::copy(std::begin(SaveState::magic), std::end(SaveState::magic), header.magic);
+    header.version = SaveState::version;
+    header.size = static_cast<uint32_t>(saveStateSize);
+    header.romHash = cartridge.romImage ? cartridge.romImage->getHash() : 0;
+    return header;
+}
+
+// Fields are written in a fixed order, readState() has to match it exactly
+void NES::writeState(SaveState::Writer &writer)
+{
+    writer.write(makeSaveStateHeader());
+
+    cpu.saveState(writer);
+    scheduler.saveState(writer);
+
+    writer.write(frameCount);
+    writer.write(vblankFrame);
+    writer.write(irqSources);
+    writer.write(ram);
+
+    ppu.saveState(writer);
+    writer.write(apuRegisters);
+    writer.write(controllerShifters);
+    writer.write(controllerStrobe);
+
+    writer.writeBytes(cartridge.prgRAM.data(), cartridge.prgRAM.size());
+    writer.writeBytes(cartridge.chrRAM.data(), cartridge.chrRAM.size());
+
+    mapper->saveState(writer);
+}
+
+void NES::readState(SaveState::Reader &reader)
+{
+    SaveState::Header header;
+    reader.read(header);
+
+    cpu.loadState(reader);
+    scheduler.loadState(reader);
+
+    reader.read(frameCount);
+    reader.read(vblankFrame);
+    reader.read(irqSources);
+    reader.read(ram);
+
+    ppu.loadState(reader);
+    reader.read(apuRegisters);
+    reader.read(controllerShifters);
+    reader.read(controllerStrobe);
+
+    reader.readBytes(cartridge.prgRAM.data(), cartridge.prgRAM.size());
+    reader.readBytes(cartridge.chrRAM.data(), cartridge.chrRAM.size());
+
+    if (!cartridge.chrRAM.empty()) {
+        ppu.refreshTileCache();
+    }
+
+    mapper->loadState(reader);
+    mapper->mapPrgPages();
+}
+
+// Used by run-ahead for frames which are thrown away. The PPU is caught up first so lines already due are
+// drawn with the setting they were run with. That stops at the boundary of the frame about to be run, as
+// runFrame() overshoots it by up to an instruction and the lines after it belong to the next frame.
+void NES::setOutputEnabled(bool enabled)
+{
+    ppu.catchUp(std::min(cpu.getCycleCount(), getFrameEndCycle(frameCount, cartridge.region)));
+    ppu.setOutputEnabled(enabled);
+}
+
+const NES::FrameBuffer &NES::getFrameBuffer()
+{
+    return ppu.getFrameBuffer();
+}
+
+// Multi-region cartridges run as NTSC, the same as getFrameEndCycle
+double NES::getFrameRate()
+{
+    return cartridge.region == Region::pal ? 50.007 : 60.0988;
+}
+
+uint64_t NES::getFrameCount()
+{
+    return frameCount;
+}
+
+uint64_t NES::getCycleCount()
+{
+    return cpu.getCycleCount();
+}
+
+uint64_t NES::getInstructionCount()
 {
-    cpu.tick();
+    return cpu.getInstructionCount();
 }
 
 CPUState NES::getCPUState()
@@ -1,32 +1,155 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <span>
+#include <string>
 
 #include "Cartridge/Mappers/Mapper.h"
 #include "Cartridge/Cartridge.h"
 #include "CPU/CPU.h"
+#include "MemoryMap.h"
+#include "PPU/PPU.h"
+#include "SaveState.h"
+#include "Scheduler.h"
+
+// Buttons of a standard controller, numbered by the order the controller shifts them out in
+enum class Button : uint8_t
+{
+    a,
+    b,
+    select,
+    start,
+    up,
+    down,
+    left,
+    right
+};
 
 class NES
 {
 public:
+    using FrameBuffer = PPU::FrameBuffer;
+
     NES();
-    NES(CPUState &initialState);
+    NES(const std::string &romPath);
 
     uint8_t memoryRead(uint16_t address);
     void memoryWrite(uint16_t address, uint8_t value);
+    const uint8_t *getCodePointer(uint16_t address);
+    const MemoryMap &getMemoryMap();
+
+    void reset();
+
+    void setControllerButtons(int port, uint8_t buttons);  // Bit per Button, set while it's held
+
+    /* Savestates */
+    std::size_t getSaveStateSize();                    // Fixed for as long as the same cartridge is inserted
+    bool saveState(std::span<uint8_t> buffer);         // Fails if the buffer is smaller than getSaveStateSize()
+    bool loadState(std::span<const uint8_t> buffer);   // Fails, changing nothing, if the state doesn't match the
+                                                       // version or the cartridge
+
+    int tickCPU();
+    uint64_t runCycles(uint64_t cycleBudget);
+    void runFrame();
+
+    void setBlockCacheEnabled(bool enabled);
+    void setJITEnabled(bool enabled);
+    void setOutputEnabled(bool enabled);  // Frames run with output off skip generating video and audio
 
-    void tickCPU();
+    const FrameBuffer &getFrameBuffer();  // Last frame generated with output enabled
 
+    double getFrameRate();  // Refresh rate of the cartridge's region in Hz
+    uint64_t getFrameCount();
+    uint64_t getCycleCount();
+    uint64_t getInstructionCount();
     CPUState getCPUState();
 
 private:
-    std::array<uint8_t, 64 * 1024> memory {};
+    std::array<uint8_t, 2 * 1024> ram {};  // Internal RAM, mirrored four times through $0000-$1FFF
+    MemoryMap memoryMap;
 
-    CPU cpu;
+    uint64_t frameCount {};  // Number of frames which have been run to completion
+
+    CPU<NES> cpu;
+
+    Scheduler scheduler;
+    uint64_t vblankFrame {};  // Frame the pending vblank event belongs to
+    uint8_t irqSources {};    // Bit per ScheduledEvent whose interrupt is currently asserted
+
+    void runUntil(uint64_t targetCycle);
+    void handleEvent(ScheduledEvent event);
+    void setIRQSource(ScheduledEvent source, bool asserted);
     
     Cartridge cartridge;
     std::unique_ptr<Mapper> mapper;
+
+    PPU ppu { cartridge };
     
-    friend class CPU;
-};
\ No newline at end of file
+    void insertCartridge(Cartridge newCartridge);
+
+    std::size_t saveStateSize {};
+
+    SaveState::Header makeSaveStateHeader();
+    void writeState(SaveState::Writer &writer);
+    void readState(SaveState::Reader &reader);
+
+    uint8_t memoryReadSlow(uint16_t address);
+    void memoryWriteSlow(uint16_t address, uint8_t value);
+
+    /**
+     * Memory Mapped Registers
+     * PPU registers are handed to the PPU along with the cycle they were accessed on. Only the parts of the APU
+     * registers the rest of the console depends on are handled so far, other writes are just kept.
+    */
+    std::array<uint8_t, 0x18> apuRegisters {};
+
+    std::array<uint8_t, 2> controllerButtons {};
+    std::array<uint8_t, 2> controllerShifters {};  // Buttons latched by the last strobe, shifted out one per read
+    bool controllerStrobe {};
+
+    uint8_t readPPURegister(uint16_t address);
+    void writePPURegister(uint16_t address, uint8_t value);
+    uint8_t readIORegister(uint16_t address);
+    void writeIORegister(uint16_t address, uint8_t value);
+};
+
+inline uint8_t NES::memoryRead(uint16_t address)
+{
+    const uint8_t *page = memoryMap.getReadPage(address);
+
+    if (page != nullptr) {
+        return page[address & 0xFF];
+    }
+
+    return memoryReadSlow(address);
+}
+
+inline void NES::memoryWrite(uint16_t address, uint8_t value)
+{
+    uint8_t *page = memoryMap.getWritePage(address);
+
+    if (page != nullptr) {
+        page[address & 0xFF] = value;
+        return;
+    }
+
+    memoryWriteSlow(address, value);
+}
+
+inline const uint8_t *NES::getCodePointer(uint16_t address)
+{
+    const uint8_t *page = memoryMap.getReadPage(address);
+
+    if (page != nullptr) {
+        return page + (address & 0xFF);
+    }
+
+    return nullptr;
+}
+
+inline const MemoryMap &NES::getMemoryMap()
+{
+    return memoryMap;
+}
\ No newline at end of file
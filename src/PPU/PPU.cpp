@@ -0,0 +1,549 @@
+#include "PPU.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../Cartridge/Cartridge.h"
+
+namespace
+{
+    constexpr int dotsPerLine = 341;
+
+    // PPUCTRL
+    constexpr uint8_t incrementBy32 = 0x04;
+    constexpr uint8_t spritePatternTable = 0x08;
+    constexpr uint8_t backgroundPatternTable = 0x10;
+    constexpr uint8_t tallSprites = 0x20;
+
+    // PPUMASK
+    constexpr uint8_t grayscale = 0x01;
+    constexpr uint8_t showBackgroundLeft = 0x02;
+    constexpr uint8_t showSpritesLeft = 0x04;
+    constexpr uint8_t showBackground = 0x08;
+    constexpr uint8_t showSprites = 0x10;
+
+    // Sprite pixels are a palette entry in the low 4 bits, with these flags above it
+    constexpr uint8_t behindBackground = 0x10;
+    constexpr uint8_t fromSprite0 = 0x20;
+}
+
+PPU::PPU(Cartridge &cart) : cartridge(cart), frameBuffers(std::make_unique<std::array<FrameBuffer, 2>>())
+{
+}
+
+void PPU::reset()
+{
+    control = 0;
+    mask = 0;
+    oamAddress = 0;
+    latch = 0;
+    readBuffer = 0;
+
+    vramAddress = 0;
+    tempAddress = 0;
+    fineX = 0;
+    writeToggle = false;
+
+    vblankFlag = false;
+    spriteOverflow = false;
+    sprite0HitDot = noHit;
+
+    nametables.fill(0);
+    palette.fill(0);
+    oam.fill(0);
+
+    nextLine = 0;
+    (*frameBuffers)[0].fill(0);
+    (*frameBuffers)[1].fill(0);
+
+    refreshTileCache();  // The cartridge may have been swapped since the last reset
+}
+
+// The eight registers are mirrored every 8 bytes through $2000-$3FFF
+uint8_t PPU::readRegister(uint16_t address, uint64_t cycle)
+{
+    catchUp(cycle);
+
+    switch (address & 0x7) {
+        case 0x2: {  // PPUSTATUS, reading it acknowledges vblank
+            const bool sprite0Hit = getDot(cycle) >= sprite0HitDot;
+            const uint8_t status = (vblankFlag << 7) | (sprite0Hit << 6) | (spriteOverflow << 5) | (latch & 0x1F);
+            vblankFlag = false;
+            writeToggle = false;
+            return status;
+        }
+        case 0x4:  // OAMDATA
+            return oam[oamAddress];
+        case 0x7: {  // PPUDATA, the palette is read straight away but everything else comes through the buffer
+            const uint16_t vram = vramAddress & 0x3FFF;
+            uint8_t value;
+
+            if (vram >= 0x3F00) {
+                value = (palette[getPaletteIndex(vram)] & 0x3F) | (latch & 0xC0);
+                readBuffer = read(vram - 0x1000);  // The nametable byte underneath the palette
+            } else {
+                value = readBuffer;
+                readBuffer = read(vram);
+            }
+
+            vramAddress = (vramAddress + ((control & incrementBy32) ? 32 : 1)) & 0x7FFF;
+            return value;
+        }
+        default:
+            return latch;
+    }
+}
+
+void PPU::writeRegister(uint16_t address, uint8_t value, uint64_t cycle)
+{
+    catchUp(cycle);
+    latch = value;
+
+    switch (address & 0x7) {
+        case 0x0:  // PPUCTRL, the low bits select the nametable the next frame starts from
+            control = value;
+            tempAddress = (tempAddress & ~0x0C00) | ((value & 0x03) << 10);
+            break;
+        case 0x1:  // PPUMASK
+            mask = value;
+            break;
+        case 0x3:  // OAMADDR
+            oamAddress = value;
+            break;
+        case 0x4:  // OAMDATA
+            oam[oamAddress++] = value;
+            break;
+        case 0x5:  // PPUSCROLL, X then Y
+            if (!writeToggle) {
+                tempAddress = (tempAddress & ~0x001F) | (value >> 3);
+                fineX = value & 0x07;
+            } else {
+                tempAddress = (tempAddress & ~0x73E0) | ((value & 0x07) << 12) | ((value & 0xF8) << 2);
+            }
+            writeToggle = !writeToggle;
+            break;
+        case 0x6:  // PPUADDR, high byte then low byte, which takes effect straight away
+            if (!writeToggle) {
+                tempAddress = (tempAddress & 0x00FF) | ((value & 0x3F) << 8);
+            } else {
+                tempAddress = (tempAddress & 0xFF00) | value;
+                vramAddress = tempAddress;
+            }
+            writeToggle = !writeToggle;
+            break;
+        case 0x7:  // PPUDATA
+            write(vramAddress & 0x3FFF, value);
+            vramAddress = (vramAddress + ((control & incrementBy32) ? 32 : 1)) & 0x7FFF;
+            break;
+        default:
+            break;
+    }
+}
+
+// Copies a page into sprite memory starting from OAMADDR, the same as 256 writes to OAMDATA
+void PPU::writeOAMDMA(std::span<const uint8_t, 256> page, uint64_t cycle)
+{
+    catchUp(cycle);
+
+    for (int i = 0; i < 256; i++) {
+        oam[(oamAddress + i) & 0xFF] = page[i];
+    }
+}
+
+// Each visible line is drawn once the PPU has passed dot 257 of the line before, where it reloads the horizontal
+// scroll. The first line of a frame is drawn from the start of the frame instead, so no line of a frame is drawn
+// before its first dot. The CPU can run a few cycles past a frame boundary, so NES::setOutputEnabled() only
+// catches up to the boundary for lines to be drawn with their own frame's output setting.
+void PPU::catchUp(uint64_t cycle)
+{
+    const uint64_t dot = getDot(cycle);
+
+    while (getLineDrawDot(nextLine) < dot) {
+        const int line = static_cast<int>(nextLine % screenHeight);
+        const uint64_t frameStartDot = nextLine / screenHeight * dotsPerLine * getLinesPerFrame();
+
+        if (isRenderingEnabled()) {
+            if (line == 0) {
+                vramAddress = tempAddress;  // The pre-render line reloads the horizontal and vertical scroll
+            } else {
+                incrementY();
+                copyHorizontalScroll();
+            }
+        }
+
+        drawLine(line, frameStartDot + line * dotsPerLine);
+        nextLine++;
+
+        if (line == screenHeight - 1 && outputEnabled) {
+            frontBuffer ^= 1;
+        }
+    }
+}
+
+void PPU::startVblank(uint64_t cycle)
+{
+    catchUp(cycle);
+    vblankFlag = true;
+}
+
+void PPU::endVblank(uint64_t cycle)
+{
+    catchUp(cycle);
+    vblankFlag = false;
+    spriteOverflow = false;
+    sprite0HitDot = noHit;
+}
+
+void PPU::setOutputEnabled(bool enabled)
+{
+    outputEnabled = enabled;
+}
+
+// CHR-ROM never changes, so its tiles are decoded once per ROM image. Only CHR-RAM needs a cache of its own.
+void PPU::refreshTileCache()
+{
+    if (!cartridge.chrROM.empty()) {
+        chrRAMTileCache.reset();
+        tileCache = &cartridge.romImage->getTileCache(cartridge.chrROM);
+        return;
+    }
+
+    if (chrRAMTileCache == nullptr) {
+        chrRAMTileCache = std::make_unique<TileCache>();
+    }
+
+    chrRAMTileCache->update(cartridge.chrRAM);
+    tileCache = chrRAMTileCache.get();
+}
+
+// Fields are written in a fixed order, loadState() has to match it exactly
+void PPU::saveState(SaveState::Writer &writer) const
+{
+    writer.write(control);
+    writer.write(mask);
+    writer.write(oamAddress);
+    writer.write(latch);
+    writer.write(readBuffer);
+    writer.write(vramAddress);
+    writer.write(tempAddress);
+    writer.write(fineX);
+    writer.write(writeToggle);
+    writer.write(vblankFlag);
+    writer.write(spriteOverflow);
+    writer.write(sprite0HitDot);
+    writer.write(nextLine);
+    writer.write(nametables);
+    writer.write(palette);
+    writer.write(oam);
+}
+
+void PPU::loadState(SaveState::Reader &reader)
+{
+    reader.read(control);
+    reader.read(mask);
+    reader.read(oamAddress);
+    reader.read(latch);
+    reader.read(readBuffer);
+    reader.read(vramAddress);
+    reader.read(tempAddress);
+    reader.read(fineX);
+    reader.read(writeToggle);
+    reader.read(vblankFlag);
+    reader.read(spriteOverflow);
+    reader.read(sprite0HitDot);
+    reader.read(nextLine);
+    reader.read(nametables);
+    reader.read(palette);
+    reader.read(oam);
+}
+
+bool PPU::isRenderingEnabled() const
+{
+    return mask & (showBackground | showSprites);
+}
+
+int PPU::getLinesPerFrame() const
+{
+    return cartridge.region == Region::pal ? 312 : 262;
+}
+
+// NTSC runs 3 dots per CPU cycle, PAL 3.2
+uint64_t PPU::getDot(uint64_t cycle) const
+{
+    return cartridge.region == Region::pal ? cycle * 16 / 5 : cycle * 3;
+}
+
+uint64_t PPU::getLineDrawDot(uint64_t line) const
+{
+    const uint64_t frameStartDot = line / screenHeight * dotsPerLine * getLinesPerFrame();
+    const uint64_t lineInFrame = line % screenHeight;
+
+    return lineInFrame == 0 ? frameStartDot : frameStartDot + (lineInFrame - 1) * dotsPerLine + 257;
+}
+
+// With output off, the line is only drawn if it could hit sprite 0
+void PPU::drawLine(int line, uint64_t lineStartDot)
+{
+    uint8_t *output = (*frameBuffers)[frontBuffer ^ 1].data() + line * screenWidth;
+    const uint8_t colourMask = (mask & grayscale) ? 0x30 : 0x3F;
+
+    if (!isRenderingEnabled()) {
+        if (outputEnabled) {
+            std::fill_n(output, screenWidth, palette[0] & colourMask);
+        }
+        return;
+    }
+
+    std::array<uint8_t, maxSpritesPerLine> sprites;
+    const int spriteCount = evaluateSprites(line, sprites);
+
+    const bool canHitSprite0 = spriteCount != 0 && sprites[0] == 0 && sprite0HitDot == noHit
+                            && (mask & (showBackground | showSprites)) == (showBackground | showSprites);
+
+    if (!outputEnabled && !canHitSprite0) {
+        return;
+    }
+
+    std::array<uint8_t, screenWidth> background {};
+    std::array<uint8_t, screenWidth> spritePixels {};
+
+    if (mask & showBackground) {
+        drawBackground(background);
+
+        if (!(mask & showBackgroundLeft)) {
+            std::fill_n(background.begin(), 8, 0);
+        }
+    }
+
+    if (mask & showSprites) {
+        drawSprites(line, sprites, spriteCount, spritePixels);
+
+        if (!(mask & showSpritesLeft)) {
+            std::fill_n(spritePixels.begin(), 8, 0);
+        }
+    }
+
+    // Sprite 0 hits where an opaque pixel of it lands on opaque background, anywhere but the last column
+    if (canHitSprite0) {
+        for (int x = 0; x < screenWidth - 1; x++) {
+            if ((spritePixels[x] & fromSprite0) && (spritePixels[x] & 0x03) && (background[x] & 0x03)) {
+                sprite0HitDot = lineStartDot + x + 1;
+                break;
+            }
+        }
+    }
+
+    if (!outputEnabled) {
+        return;
+    }
+
+    for (int x = 0; x < screenWidth; x++) {
+        const uint8_t backgroundPixel = background[x];
+        const uint8_t spritePixel = spritePixels[x];
+        int entry = 0;  // Backdrop
+
+        if ((spritePixel & 0x03) && (!(spritePixel & behindBackground) || !(backgroundPixel & 0x03))) {
+            entry = 0x10 | (spritePixel & 0x0F);
+        } else if (backgroundPixel & 0x03) {
+            entry = backgroundPixel;
+        }
+
+        output[x] = palette[entry] & colourMask;
+    }
+}
+
+// Fills in each pixel's palette entry. Transparent pixels keep their palette bits, so only the low 2 bits say
+// whether there's anything there.
+void PPU::drawBackground(std::array<uint8_t, screenWidth> &pixels)
+{
+    const uint16_t patternTable = (control & backgroundPatternTable) ? 0x1000 : 0x0000;
+    const int fineY = (vramAddress >> 12) & 0x07;
+
+    // 33 tiles, as fine X scroll leaves part of one showing at each edge
+    std::array<uint8_t, (screenWidth / 8 + 1) * 8> tiles;
+    uint16_t address = vramAddress;
+
+    for (int tile = 0; tile <= screenWidth / 8; tile++) {
+        const uint8_t tileIndex = getNametableByte(0x2000 | (address & 0x0FFF));
+        const uint8_t attribute = getNametableByte(0x23C0 | (address & 0x0C00) | ((address >> 4) & 0x38) | ((address >> 2) & 0x07));
+        const int attributeShift = ((address >> 4) & 0x04) | (address & 0x02);
+        const uint64_t paletteBits = ((attribute >> attributeShift) & 0x03) << 2;
+
+        // The whole row of 8 pixels goes at once, with the palette bits copied into every byte
+        uint64_t row;
+        std::memcpy(&row, tileCache->getRow(patternTable + tileIndex * 16 + fineY, false), sizeof(row));
+        row |= paletteBits * 0x0101010101010101;
+        std::memcpy(&tiles[tile * 8], &row, sizeof(row));
+
+        // Coarse X wraps into the horizontally neighbouring nametable
+        if ((address & 0x001F) == 31) {
+            address = (address & ~0x001F) ^ 0x0400;
+        } else {
+            address++;
+        }
+    }
+
+    std::memcpy(pixels.data(), &tiles[fineX], screenWidth);
+}
+
+// Picks out the first eight sprites on the line in OAM order, flagging overflow if there are more.
+// The hardware's buggy overflow search isn't reproduced.
+int PPU::evaluateSprites(int line, std::array<uint8_t, maxSpritesPerLine> &sprites)
+{
+    const int height = (control & tallSprites) ? 16 : 8;
+    int count = 0;
+
+    for (int i = 0; i < 64; i++) {
+        const int row = line - oam[i * 4] - 1;  // Sprites show up one line below their Y coordinate
+
+        if (row < 0 || row >= height) {
+            continue;
+        }
+
+        if (count == maxSpritesPerLine) {
+            spriteOverflow = true;
+            break;
+        }
+
+        sprites[count++] = static_cast<uint8_t>(i);
+    }
+
+    return count;
+}
+
+// Earlier sprites in OAM are in front of later ones, whatever their priority against the background
+void PPU::drawSprites(int line, const std::array<uint8_t, maxSpritesPerLine> &sprites, int spriteCount,
+                      std::array<uint8_t, screenWidth> &pixels)
+{
+    const int height = (control & tallSprites) ? 16 : 8;
+
+    for (int n = 0; n < spriteCount; n++) {
+        const uint8_t *sprite = &oam[sprites[n] * 4];
+        const uint8_t tileIndex = sprite[1];
+        const uint8_t attributes = sprite[2];
+
+        int row = line - sprite[0] - 1;
+        if (attributes & 0x80) {  // Vertical flip
+            row = height - 1 - row;
+        }
+
+        uint16_t patternAddress;
+        if (height == 16) {  // 8x16 sprites pick their pattern table with bit 0 of the tile index
+            patternAddress = ((tileIndex & 0x01) ? 0x1000 : 0x0000) + (tileIndex & 0xFE) * 16 + (row & 0x08) * 2 + (row & 0x07);
+        } else {
+            patternAddress = ((control & spritePatternTable) ? 0x1000 : 0x0000) + tileIndex * 16 + row;
+        }
+
+        const uint8_t *tilePixels = tileCache->getRow(patternAddress, attributes & 0x40);  // Horizontal flip
+        const uint8_t flags = ((attributes & 0x03) << 2) | ((attributes & 0x20) ? behindBackground : 0)
+                            | (sprites[n] == 0 ? fromSprite0 : 0);
+
+        for (int column = 0; column < 8; column++) {
+            const int x = sprite[3] + column;
+
+            if (x >= screenWidth) {
+                break;
+            }
+
+            const uint8_t pattern = tilePixels[column];
+
+            if (pattern != 0 && (pixels[x] & 0x03) == 0) {
+                pixels[x] = flags | pattern;
+            }
+        }
+    }
+}
+
+// Moves v down a line at the end of each visible line, wrapping from the bottom of the nametable into the one below
+void PPU::incrementY()
+{
+    if ((vramAddress & 0x7000) != 0x7000) {
+        vramAddress += 0x1000;
+        return;
+    }
+
+    vramAddress &= ~0x7000;
+    int coarseY = (vramAddress & 0x03E0) >> 5;
+
+    if (coarseY == 29) {
+        coarseY = 0;
+        vramAddress ^= 0x0800;
+    } else if (coarseY == 31) {  // Out of range scroll wraps without switching nametable
+        coarseY = 0;
+    } else {
+        coarseY++;
+    }
+
+    vramAddress = (vramAddress & ~0x03E0) | (coarseY << 5);
+}
+
+void PPU::copyHorizontalScroll()
+{
+    vramAddress = (vramAddress & ~0x041F) | (tempAddress & 0x041F);
+}
+
+// Only NROM is supported so far, so CHR isn't banked. Boards without CHR-ROM have CHR-RAM instead.
+std::span<const uint8_t> PPU::getCHR() const
+{
+    if (!cartridge.chrROM.empty()) {
+        return cartridge.chrROM;
+    }
+
+    return cartridge.chrRAM;
+}
+
+uint8_t PPU::readCHR(uint16_t address) const
+{
+    const std::span<const uint8_t> chr = getCHR();
+    return chr.empty() ? 0 : chr[address % chr.size()];
+}
+
+// PPU address space: pattern tables, then nametables mirrored up to the palette at $3F00
+uint8_t PPU::read(uint16_t address)
+{
+    if (address < 0x2000) {
+        return readCHR(address);
+    } else if (address < 0x3F00) {
+        return getNametableByte(address);
+    } else {
+        return palette[getPaletteIndex(address)];
+    }
+}
+
+void PPU::write(uint16_t address, uint8_t value)
+{
+    if (address < 0x2000) {
+        if (cartridge.chrROM.empty() && !cartridge.chrRAM.empty()) {
+            const std::size_t size = cartridge.chrRAM.size();
+            cartridge.chrRAM[address % size] = value;
+
+            // CHR-RAM under 8KB shows up more than once in the pattern tables
+            for (std::size_t mirror = address % size; mirror < 0x2000; mirror += size) {
+                chrRAMTileCache->write(static_cast<uint16_t>(mirror), value);
+            }
+        }
+    } else if (address < 0x3F00) {
+        getNametableByte(address) = value;
+    } else {
+        palette[getPaletteIndex(address)] = value & 0x3F;
+    }
+}
+
+// The console only has room for two nametables, the cartridge wires up which of the four addresses share them
+uint8_t &PPU::getNametableByte(uint16_t address)
+{
+    const int table = cartridge.nametable == Nametable::verticalArrangement ? (address >> 11) & 0x01 : (address >> 10) & 0x01;
+    return nametables[table * 0x400 + (address & 0x03FF)];
+}
+
+// The backdrop entries of the sprite palettes are mirrors of the background ones
+int PPU::getPaletteIndex(uint16_t address)
+{
+    int index = address & 0x1F;
+
+    if ((index & 0x13) == 0x10) {
+        index &= 0x0F;
+    }
+
+    return index;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+
+#include "../SaveState.h"
+#include "TileCache.h"
+
+typedef struct Cartridge Cartridge;
+
+/**
+ *  Picture Processing Unit
+ *  Rather than being stepped alongside the CPU, the PPU lags behind it and only catches up when something could
+ *  tell the difference: the CPU touching one of its registers, or vblank arriving. Catching up draws each whole
+ *  scanline in one go, from the registers as they stand at dot 257 of the line before, which is when the PPU
+ *  reloads its horizontal scroll. Writes made part way through a frame, such as scroll splits, therefore land
+ *  on the same line they would on hardware. Sprite 0 hits are timed to the dot they happen on, so polling
+ *  PPUSTATUS sees them at the right moment even though the line was drawn ahead of time.
+ *  https://www.nesdev.org/wiki/PPU
+*/
+
+class PPU
+{
+public:
+    static constexpr int screenWidth = 256;
+    static constexpr int screenHeight = 240;
+
+    using FrameBuffer = std::array<uint8_t, screenWidth * screenHeight>;  // Palette index of each pixel
+
+    PPU(Cartridge &cart);
+
+    void reset();
+
+    // Registers at $2000-$2007, accessed on the given CPU cycle
+    uint8_t readRegister(uint16_t address, uint64_t cycle);
+    void writeRegister(uint16_t address, uint8_t value, uint64_t cycle);
+    void writeOAMDMA(std::span<const uint8_t, 256> page, uint64_t cycle);
+
+    void catchUp(uint64_t cycle);  // Draws every scanline due before the given CPU cycle
+
+    /* Vblank, timed by the NES's scheduler */
+    void startVblank(uint64_t cycle);
+    void endVblank(uint64_t cycle);  // Start of the pre-render line, which also clears the sprite flags
+    bool isInVblank() const;
+    bool isNMIEnabled() const;
+
+    void setOutputEnabled(bool enabled);  // Lines drawn with output off only work out sprite 0 hits
+    const FrameBuffer &getFrameBuffer() const;  // Last whole frame drawn with output on
+
+    void refreshTileCache();  // Picks up CHR-RAM changed from outside the PPU, such as by loading a state
+
+    void saveState(SaveState::Writer &writer) const;
+    void loadState(SaveState::Reader &reader);
+
+private:
+    static constexpr uint64_t noHit = std::numeric_limits<uint64_t>::max();
+    static constexpr int maxSpritesPerLine = 8;
+
+    Cartridge &cartridge;
+
+    /* Registers */
+    uint8_t control {};     // PPUCTRL
+    uint8_t mask {};        // PPUMASK
+    uint8_t oamAddress {};  // OAMADDR
+    uint8_t latch {};       // Last value written to any register, returned by reads of write-only ones
+    uint8_t readBuffer {};  // PPUDATA reads below the palette return the byte fetched by the previous read
+
+    // Internal scroll registers: https://www.nesdev.org/wiki/PPU_scrolling
+    uint16_t vramAddress {};  // v, current address and scroll
+    uint16_t tempAddress {};  // t, scroll for the top left of the next frame
+    uint8_t fineX {};         // x
+    bool writeToggle {};      // w, first or second write of PPUSCROLL and PPUADDR
+
+    bool vblankFlag {};
+    bool spriteOverflow {};
+    uint64_t sprite0HitDot { noHit };  // Dot the sprite 0 hit of this frame happens on, if there is one
+
+    /* Memory */
+    std::array<uint8_t, 0x800> nametables {};
+    std::array<uint8_t, 0x20> palette {};
+    std::array<uint8_t, 0x100> oam {};
+
+    /* Rendering */
+    uint64_t nextLine {};  // Count of visible lines drawn since reset, so the next one to draw
+    bool outputEnabled { true };
+    const TileCache *tileCache {};  // Shared by every console running the same CHR-ROM, or chrRAMTileCache
+    std::unique_ptr<TileCache> chrRAMTileCache;
+
+    // Frame being drawn and the last whole one. Allocated separately, so the console itself stays small.
+    std::unique_ptr<std::array<FrameBuffer, 2>> frameBuffers;
+    int frontBuffer {};
+
+    bool isRenderingEnabled() const;
+    int getLinesPerFrame() const;
+    uint64_t getDot(uint64_t cycle) const;
+    uint64_t getLineDrawDot(uint64_t line) const;
+
+    void drawLine(int line, uint64_t lineStartDot);
+    void drawBackground(std::array<uint8_t, screenWidth> &pixels);
+    int evaluateSprites(int line, std::array<uint8_t, maxSpritesPerLine> &sprites);
+    void drawSprites(int line, const std::array<uint8_t, maxSpritesPerLine> &sprites, int spriteCount,
+                     std::array<uint8_t, screenWidth> &pixels);
+
+    void incrementY();
+    void copyHorizontalScroll();
+
+    std::span<const uint8_t> getCHR() const;
+    uint8_t readCHR(uint16_t address) const;
+    uint8_t read(uint16_t address);
+    void write(uint16_t address, uint8_t value);
+    uint8_t &getNametableByte(uint16_t address);
+    static int getPaletteIndex(uint16_t address);
+};
+
+inline bool PPU::isInVblank() const
+{
+    return vblankFlag;
+}
+
+inline bool PPU::isNMIEnabled() const
+{
+    return control & 0x80;
+}
+
+inline const PPU::FrameBuffer &PPU::getFrameBuffer() const
+{
+    return (*frameBuffers)[frontBuffer];
+}
@@ -0,0 +1,485 @@
+#include "PixelKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(NESBUDDY_PIXEL_KERNELS_X64)
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define NESBUDDY_TARGET(instructionSet)
+    #else
+        #define NESBUDDY_TARGET(instructionSet) __attribute__((target(instructionSet)))
+    #endif
+#endif
+
+namespace
+{
+    std::atomic<PixelKernels::InstructionSet> &getSelectedInstructionSet()
+    {
+        static std::atomic<PixelKernels::InstructionSet> selected { PixelKernels::getSupportedInstructionSet() };
+        return selected;
+    }
+
+    PixelKernels::InstructionSet detectInstructionSet()
+    {
+#if defined(NESBUDDY_PIXEL_KERNELS_X64) && defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        const bool hasSSSE3 = info[2] & (1 << 9);
+        const bool hasOSXSAVE = info[2] & (1 << 27);
+        const bool hasAVX = info[2] & (1 << 28);
+
+        // AVX2 also needs the OS to save the upper halves of the registers
+        bool hasAVX2 = false;
+        if (hasOSXSAVE && hasAVX && (_xgetbv(0) & 0x06) == 0x06) {
+            __cpuidex(info, 7, 0);
+            hasAVX2 = info[1] & (1 << 5);
+        }
+
+        return hasAVX2 ? PixelKernels::InstructionSet::avx2
+             : hasSSSE3 ? PixelKernels::InstructionSet::ssse3 : PixelKernels::InstructionSet::scalar;
+#elif defined(NESBUDDY_PIXEL_KERNELS_X64)
+        // Checks CPUID and that the OS saves the AVX registers
+        __builtin_cpu_init();
+
+        return __builtin_cpu_supports("avx2") ? PixelKernels::InstructionSet::avx2
+             : __builtin_cpu_supports("ssse3") ? PixelKernels::InstructionSet::ssse3 : PixelKernels::InstructionSet::scalar;
+#else
+        return PixelKernels::InstructionSet::scalar;
+#endif
+    }
+
+    void decodeTilesScalar(const uint8_t *patterns, std::size_t tileCount, uint8_t *pixels, uint8_t *flippedPixels)
+    {
+        for (std::size_t tile = 0; tile < tileCount; tile++, patterns += 16, pixels += 64, flippedPixels += 64) {
+            for (int row = 0; row < 8; row++) {
+                const uint8_t lowPlane = patterns[row];
+                const uint8_t highPlane = patterns[row + 8];
+
+                // Bit 7 of each plane is the leftmost pixel
+                for (int column = 0; column < 8; column++) {
+                    const int bit = 7 - column;
+                    const uint8_t pixel = ((lowPlane >> bit) & 0x01) | (((highPlane >> bit) & 0x01) << 1);
+
+                    pixels[row * 8 + column] = pixel;
+                    flippedPixels[row * 8 + 7 - column] = pixel;
+                }
+            }
+        }
+    }
+
+    void expandPaletteScalar(const uint8_t *indices, std::size_t count, const PixelKernels::PaletteTable &palette, uint32_t *output)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            output[i] = palette.colours[indices[i] & 0x3F];
+        }
+    }
+
+    /**
+     *  The hash runs four 64 bit lanes, each taking 8 bytes of every 32 byte stripe. Each word is XORed with a
+     *  key which moves on every stripe, so the same bytes hash differently in different places, and the two
+     *  halves of the result are multiplied together into the lane. A 32x32 bit multiply per lane is all SSE2
+     *  and AVX2 have, which is why it's that rather than a full 64 bit one.
+    */
+
+    constexpr std::size_t hashStripeSize = 32;
+    constexpr uint64_t hashKeyStep = 0x9E3779B97F4A7C15;
+
+    struct HashState
+    {
+        uint64_t accumulators[4] { 0x243F6A8885A308D3, 0x13198A2E03707344, 0xA4093822299F31D0, 0x082EFA98EC4E6C89 };
+        uint64_t keys[4] { 0x452821E638D01377, 0xBE5466CF34E90C6C, 0xC0AC29B7C97C50DD, 0x3F84D5B5B5470917 };
+    };
+
+    void hashStripesScalar(const uint8_t *data, std::size_t stripeCount, HashState &state)
+    {
+        for (std::size_t stripe = 0; stripe < stripeCount; stripe++, data += hashStripeSize) {
+            for (int lane = 0; lane < 4; lane++) {
+                uint64_t value;
+                std::memcpy(&value, data + lane * sizeof(value), sizeof(value));
+
+                const uint64_t keyed = value ^ state.keys[lane];
+                state.accumulators[lane] += (keyed & 0xFFFFFFFF) * (keyed >> 32) + value;
+                state.keys[lane] += hashKeyStep;
+            }
+        }
+    }
+
+    uint64_t mixBits(uint64_t value)
+    {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+
+    // Hashes whatever's left over as a zero padded stripe, then folds the lanes and the size together
+    uint64_t finishHash(const uint8_t *tail, std::size_t size, HashState &state)
+    {
+        const std::size_t tailSize = size % hashStripeSize;
+
+        if (tailSize != 0) {
+            uint8_t stripe[hashStripeSize] {};
+            std::memcpy(stripe, tail, tailSize);
+            hashStripesScalar(stripe, 1, state);
+        }
+
+        uint64_t hash = size * hashKeyStep;
+        for (const uint64_t accumulator : state.accumulators) {
+            hash = mixBits(hash ^ accumulator);
+        }
+
+        return hash;
+    }
+
+#if defined(NESBUDDY_PIXEL_KERNELS_X64)
+    /**
+     *  Tile decode broadcasts each plane byte across the 8 bytes of its row with a shuffle, then tests a
+     *  different bit in each byte. Listing the bits the other way round gives the flipped row for free.
+    */
+
+    NESBUDDY_TARGET("ssse3")
+    void decodeTilesSSSE3(const uint8_t *patterns, std::size_t tileCount, uint8_t *pixels, uint8_t *flippedPixels)
+    {
+        const __m128i bits = _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+        const __m128i flippedBits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        const __m128i ones = _mm_set1_epi8(1);
+        const __m128i twos = _mm_set1_epi8(2);
+
+        // Two rows at a time
+        const __m128i lowIndices[4] = {
+            _mm_set_epi64x(0x0101010101010101, 0x0000000000000000),
+            _mm_set_epi64x(0x0303030303030303, 0x0202020202020202),
+            _mm_set_epi64x(0x0505050505050505, 0x0404040404040404),
+            _mm_set_epi64x(0x0707070707070707, 0x0606060606060606),
+        };
+        const __m128i highPlaneOffset = _mm_set1_epi8(8);
+
+        for (std::size_t tile = 0; tile < tileCount; tile++, patterns += 16, pixels += 64, flippedPixels += 64) {
+            const __m128i planes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(patterns));
+
+            for (int pair = 0; pair < 4; pair++) {
+                const __m128i lowPlane = _mm_shuffle_epi8(planes, lowIndices[pair]);
+                const __m128i highPlane = _mm_shuffle_epi8(planes, _mm_add_epi8(lowIndices[pair], highPlaneOffset));
+
+                const __m128i rowPixels = _mm_or_si128(
+                    _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(lowPlane, bits), bits), ones),
+                    _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(highPlane, bits), bits), twos));
+                const __m128i flippedRowPixels = _mm_or_si128(
+                    _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(lowPlane, flippedBits), flippedBits), ones),
+                    _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(highPlane, flippedBits), flippedBits), twos));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(pixels + pair * 16), rowPixels);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(flippedPixels + pair * 16), flippedRowPixels);
+            }
+        }
+    }
+
+    // Four rows at a time, the first two from the low lane and the next two from the high one
+    NESBUDDY_TARGET("avx2")
+    void decodeTilesAVX2(const uint8_t *patterns, std::size_t tileCount, uint8_t *pixels, uint8_t *flippedPixels)
+    {
+        const __m256i bits = _mm256_set1_epi64x(0x0102040810204080);
+        const __m256i flippedBits = _mm256_set1_epi64x(static_cast<int64_t>(0x8040201008040201));
+        const __m256i ones = _mm256_set1_epi8(1);
+        const __m256i twos = _mm256_set1_epi8(2);
+
+        const __m256i lowIndices[2] = {
+            _mm256_setr_epi64x(0x0000000000000000, 0x0101010101010101, 0x0202020202020202, 0x0303030303030303),
+            _mm256_setr_epi64x(0x0404040404040404, 0x0505050505050505, 0x0606060606060606, 0x0707070707070707),
+        };
+        const __m256i highPlaneOffset = _mm256_set1_epi8(8);
+
+        for (std::size_t tile = 0; tile < tileCount; tile++, patterns += 16, pixels += 64, flippedPixels += 64) {
+            const __m256i planes = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(patterns)));
+
+            for (int half = 0; half < 2; half++) {
+                const __m256i lowPlane = _mm256_shuffle_epi8(planes, lowIndices[half]);
+                const __m256i highPlane = _mm256_shuffle_epi8(planes, _mm256_add_epi8(lowIndices[half], highPlaneOffset));
+
+                const __m256i rowPixels = _mm256_or_si256(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(lowPlane, bits), bits), ones),
+                    _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(highPlane, bits), bits), twos));
+                const __m256i flippedRowPixels = _mm256_or_si256(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(lowPlane, flippedBits), flippedBits), ones),
+                    _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(highPlane, flippedBits), flippedBits), twos));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(pixels + half * 32), rowPixels);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(flippedPixels + half * 32), flippedRowPixels);
+            }
+        }
+    }
+
+    /**
+     *  A byte shuffle can only look up 16 entries, so each colour channel is looked up in the four blocks of 16
+     *  colours in turn, with the index moved down by 16 each time. Indices which go negative pick out zero, and
+     *  ones still 16 or over pick out the wrong entry, but as each block is XORed with the one before the wrong
+     *  entries cancel out and leave just the colour from the right block.
+    */
+
+    NESBUDDY_TARGET("ssse3")
+    void expandPaletteSSSE3(const uint8_t *indices, std::size_t count, const PixelKernels::PaletteTable &palette, uint32_t *output)
+    {
+        __m128i blocks[4][4];
+        for (int channel = 0; channel < 4; channel++) {
+            for (int block = 0; block < 4; block++) {
+                blocks[channel][block] = _mm_load_si128(reinterpret_cast<const __m128i *>(&palette.planes[channel][block * 16]));
+            }
+        }
+
+        // Alpha is usually the same for every colour, in which case it doesn't need looking up
+        const int lookedUpChannels = palette.hasConstantAlpha ? 3 : 4;
+        const __m128i constantAlpha = _mm_set1_epi8(static_cast<char>(palette.colours[0] >> 24));
+
+        const __m128i indexMask = _mm_set1_epi8(0x3F);
+        const __m128i blockSize = _mm_set1_epi8(16);
+        std::size_t i = 0;
+
+        for (; i + 16 <= count; i += 16) {
+            __m128i blockIndices[4];
+            blockIndices[0] = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(indices + i)), indexMask);
+            for (int block = 1; block < 4; block++) {
+                blockIndices[block] = _mm_sub_epi8(blockIndices[block - 1], blockSize);
+            }
+
+            __m128i channels[4];
+            channels[3] = constantAlpha;
+
+            for (int channel = 0; channel < lookedUpChannels; channel++) {
+                channels[channel] = _mm_shuffle_epi8(blocks[channel][0], blockIndices[0]);
+                for (int block = 1; block < 4; block++) {
+                    channels[channel] = _mm_xor_si128(channels[channel], _mm_shuffle_epi8(blocks[channel][block], blockIndices[block]));
+                }
+            }
+
+            // Interleaves the planes back into 32 bit pixels
+            const __m128i blueGreenLow = _mm_unpacklo_epi8(channels[0], channels[1]);
+            const __m128i blueGreenHigh = _mm_unpackhi_epi8(channels[0], channels[1]);
+            const __m128i redAlphaLow = _mm_unpacklo_epi8(channels[2], channels[3]);
+            const __m128i redAlphaHigh = _mm_unpackhi_epi8(channels[2], channels[3]);
+
+            __m128i *pixels = reinterpret_cast<__m128i *>(output + i);
+            _mm_storeu_si128(pixels + 0, _mm_unpacklo_epi16(blueGreenLow, redAlphaLow));
+            _mm_storeu_si128(pixels + 1, _mm_unpackhi_epi16(blueGreenLow, redAlphaLow));
+            _mm_storeu_si128(pixels + 2, _mm_unpacklo_epi16(blueGreenHigh, redAlphaHigh));
+            _mm_storeu_si128(pixels + 3, _mm_unpackhi_epi16(blueGreenHigh, redAlphaHigh));
+        }
+
+        expandPaletteScalar(indices + i, count - i, palette, output + i);
+    }
+
+    // The same as the SSSE3 version 32 indices at a time. Shuffles and unpacks stay within each 16 byte lane,
+    // so the pixels come out with the lanes interleaved and are put back in order when they're stored.
+    NESBUDDY_TARGET("avx2")
+    void expandPaletteAVX2(const uint8_t *indices, std::size_t count, const PixelKernels::PaletteTable &palette, uint32_t *output)
+    {
+        __m256i blocks[4][4];
+        for (int channel = 0; channel < 4; channel++) {
+            for (int block = 0; block < 4; block++) {
+                blocks[channel][block] = _mm256_broadcastsi128_si256(
+                    _mm_load_si128(reinterpret_cast<const __m128i *>(&palette.planes[channel][block * 16])));
+            }
+        }
+
+        const int lookedUpChannels = palette.hasConstantAlpha ? 3 : 4;
+        const __m256i constantAlpha = _mm256_set1_epi8(static_cast<char>(palette.colours[0] >> 24));
+
+        const __m256i indexMask = _mm256_set1_epi8(0x3F);
+        const __m256i blockSize = _mm256_set1_epi8(16);
+        std::size_t i = 0;
+
+        for (; i + 32 <= count; i += 32) {
+            __m256i blockIndices[4];
+            blockIndices[0] = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices + i)), indexMask);
+            for (int block = 1; block < 4; block++) {
+                blockIndices[block] = _mm256_sub_epi8(blockIndices[block - 1], blockSize);
+            }
+
+            __m256i channels[4];
+            channels[3] = constantAlpha;
+
+            for (int channel = 0; channel < lookedUpChannels; channel++) {
+                channels[channel] = _mm256_shuffle_epi8(blocks[channel][0], blockIndices[0]);
+                for (int block = 1; block < 4; block++) {
+                    channels[channel] = _mm256_xor_si256(channels[channel], _mm256_shuffle_epi8(blocks[channel][block], blockIndices[block]));
+                }
+            }
+
+            const __m256i blueGreenLow = _mm256_unpacklo_epi8(channels[0], channels[1]);
+            const __m256i blueGreenHigh = _mm256_unpackhi_epi8(channels[0], channels[1]);
+            const __m256i redAlphaLow = _mm256_unpacklo_epi8(channels[2], channels[3]);
+            const __m256i redAlphaHigh = _mm256_unpackhi_epi8(channels[2], channels[3]);
+
+            // Pixels 0-3 and 16-19, 4-7 and 20-23, 8-11 and 24-27, then 12-15 and 28-31
+            const __m256i pixels0 = _mm256_unpacklo_epi16(blueGreenLow, redAlphaLow);
+            const __m256i pixels1 = _mm256_unpackhi_epi16(blueGreenLow, redAlphaLow);
+            const __m256i pixels2 = _mm256_unpacklo_epi16(blueGreenHigh, redAlphaHigh);
+            const __m256i pixels3 = _mm256_unpackhi_epi16(blueGreenHigh, redAlphaHigh);
+
+            __m256i *pixels = reinterpret_cast<__m256i *>(output + i);
+            _mm256_storeu_si256(pixels + 0, _mm256_permute2x128_si256(pixels0, pixels1, 0x20));
+            _mm256_storeu_si256(pixels + 1, _mm256_permute2x128_si256(pixels2, pixels3, 0x20));
+            _mm256_storeu_si256(pixels + 2, _mm256_permute2x128_si256(pixels0, pixels1, 0x31));
+            _mm256_storeu_si256(pixels + 3, _mm256_permute2x128_si256(pixels2, pixels3, 0x31));
+        }
+
+        expandPaletteScalar(indices + i, count - i, palette, output + i);
+    }
+
+    // SSE2 is always there on x86-64, so this is used from the SSSE3 level up
+    void hashStripesSSE2(const uint8_t *data, std::size_t stripeCount, HashState &state)
+    {
+        __m128i accumulators[2];
+        __m128i keys[2];
+        for (int half = 0; half < 2; half++) {
+            accumulators[half] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state.accumulators[half * 2]));
+            keys[half] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&state.keys[half * 2]));
+        }
+
+        const __m128i keyStep = _mm_set1_epi64x(static_cast<int64_t>(hashKeyStep));
+
+        for (std::size_t stripe = 0; stripe < stripeCount; stripe++, data += hashStripeSize) {
+            for (int half = 0; half < 2; half++) {
+                const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + half * 16));
+                const __m128i keyed = _mm_xor_si128(value, keys[half]);
+                const __m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+
+                accumulators[half] = _mm_add_epi64(accumulators[half], _mm_add_epi64(product, value));
+                keys[half] = _mm_add_epi64(keys[half], keyStep);
+            }
+        }
+
+        for (int half = 0; half < 2; half++) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(&state.accumulators[half * 2]), accumulators[half]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(&state.keys[half * 2]), keys[half]);
+        }
+    }
+
+    NESBUDDY_TARGET("avx2")
+    void hashStripesAVX2(const uint8_t *data, std::size_t stripeCount, HashState &state)
+    {
+        __m256i accumulators = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state.accumulators));
+        __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state.keys));
+        const __m256i keyStep = _mm256_set1_epi64x(static_cast<int64_t>(hashKeyStep));
+
+        for (std::size_t stripe = 0; stripe < stripeCount; stripe++, data += hashStripeSize) {
+            const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+            const __m256i keyed = _mm256_xor_si256(value, keys);
+            const __m256i product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+
+            accumulators = _mm256_add_epi64(accumulators, _mm256_add_epi64(product, value));
+            keys = _mm256_add_epi64(keys, keyStep);
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(state.accumulators), accumulators);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(state.keys), keys);
+    }
+#endif
+}
+
+namespace PixelKernels
+{
+    PaletteTable::PaletteTable(std::span<const uint32_t, 64> colours)
+    {
+        for (int i = 0; i < 64; i++) {
+            this->colours[i] = colours[i];
+
+            for (int channel = 0; channel < 4; channel++) {
+                const uint8_t value = static_cast<uint8_t>(colours[i] >> (channel * 8));
+                const uint8_t previousBlockValue = i >= 16 ? static_cast<uint8_t>(colours[i - 16] >> (channel * 8)) : 0;
+
+                planes[channel][i] = value ^ previousBlockValue;
+            }
+        }
+
+        hasConstantAlpha = std::all_of(colours.begin(), colours.end(), [&](uint32_t colour) {
+            return colour >> 24 == colours[0] >> 24;
+        });
+    }
+
+    InstructionSet getSupportedInstructionSet()
+    {
+        static const InstructionSet supported = detectInstructionSet();
+        return supported;
+    }
+
+    InstructionSet getInstructionSet()
+    {
+        return getSelectedInstructionSet().load(std::memory_order_relaxed);
+    }
+
+    void setInstructionSet(InstructionSet instructionSet)
+    {
+        getSelectedInstructionSet().store(std::min(instructionSet, getSupportedInstructionSet()), std::memory_order_relaxed);
+    }
+
+    const char *getName(InstructionSet instructionSet)
+    {
+        switch (instructionSet) {
+            case InstructionSet::ssse3:
+                return "SSSE3";
+            case InstructionSet::avx2:
+                return "AVX2";
+            default:
+                return "Scalar";
+        }
+    }
+
+    void decodeTiles(const uint8_t *patterns, std::size_t tileCount, uint8_t *pixels, uint8_t *flippedPixels)
+    {
+        switch (getInstructionSet()) {
+#if defined(NESBUDDY_PIXEL_KERNELS_X64)
+            case InstructionSet::avx2:
+                decodeTilesAVX2(patterns, tileCount, pixels, flippedPixels);
+                break;
+            case InstructionSet::ssse3:
+                decodeTilesSSSE3(patterns, tileCount, pixels, flippedPixels);
+                break;
+#endif
+            default:
+                decodeTilesScalar(patterns, tileCount, pixels, flippedPixels);
+                break;
+        }
+    }
+
+    void expandPalette(const uint8_t *indices, std::size_t count, const PaletteTable &palette, uint32_t *output)
+    {
+        switch (getInstructionSet()) {
+#if defined(NESBUDDY_PIXEL_KERNELS_X64)
+            case InstructionSet::avx2:
+                expandPaletteAVX2(indices, count, palette, output);
+                break;
+            case InstructionSet::ssse3:
+                expandPaletteSSSE3(indices, count, palette, output);
+                break;
+#endif
+            default:
+                expandPaletteScalar(indices, count, palette, output);
+                break;
+        }
+    }
+
+    uint64_t hashBytes(const uint8_t *data, std::size_t size)
+    {
+        HashState state;
+        const std::size_t stripeCount = size / hashStripeSize;
+
+        switch (getInstructionSet()) {
+#if defined(NESBUDDY_PIXEL_KERNELS_X64)
+            case InstructionSet::avx2:
+                hashStripesAVX2(data, stripeCount, state);
+                break;
+            case InstructionSet::ssse3:
+                hashStripesSSE2(data, stripeCount, state);
+                break;
+#endif
+            default:
+                hashStripesScalar(data, stripeCount, state);
+                break;
+        }
+
+        return finishHash(data + stripeCount * hashStripeSize, size, state);
+    }
+}
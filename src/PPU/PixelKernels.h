@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define NESBUDDY_PIXEL_KERNELS_X64
+#endif
+
+/**
+ *  Bulk pixel conversions, with SIMD versions picked at runtime from what CPUID reports, so one build runs
+ *  everywhere but still uses AVX2 where it's there. Every version gives exactly the same output as the scalar
+ *  one, which is also all there is on other architectures.
+*/
+
+namespace PixelKernels
+{
+    enum class InstructionSet
+    {
+        scalar,
+        ssse3,
+        avx2
+    };
+
+    // 64 colours split into byte planes, each XORed with the 16 colours before it, which lets the SIMD kernels
+    // look them up 16 at a time with byte shuffles. Built once per palette rather than for every call.
+    struct PaletteTable
+    {
+        explicit PaletteTable(std::span<const uint32_t, 64> colours);
+
+        std::array<uint32_t, 64> colours;
+        alignas(16) std::array<std::array<uint8_t, 64>, 4> planes;  // Blue, green, red and alpha bytes
+        bool hasConstantAlpha;
+    };
+
+    InstructionSet getSupportedInstructionSet();  // Best the CPU has, detected on first use
+    InstructionSet getInstructionSet();
+    void setInstructionSet(InstructionSet instructionSet);  // Capped to what's supported, for benchmarks and tests
+    const char *getName(InstructionSet instructionSet);
+
+    // Splits tiles of 16 bytes of CHR, 8 low plane rows then 8 high plane rows, into 64 bytes of 2 bit colour,
+    // row by row from the top left. flippedPixels gets each row mirrored.
+    void decodeTiles(const uint8_t *patterns, std::size_t tileCount, uint8_t *pixels, uint8_t *flippedPixels);
+
+    // Looks up the colour of each palette index, only the low 6 bits of which are used
+    void expandPalette(const uint8_t *indices, std::size_t count, const PaletteTable &palette, uint32_t *output);
+
+    // Quick to work out but not cryptographic, for spotting frames which are the same as one seen before
+    uint64_t hashBytes(const uint8_t *data, std::size_t size);
+}
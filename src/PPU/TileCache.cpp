@@ -0,0 +1,40 @@
+#include "TileCache.h"
+
+#include <cstring>
+
+#include "PixelKernels.h"
+
+// Comparing 16 bytes a tile is much cheaper than decoding it, so this is fine to call after every state load
+void TileCache::update(std::span<const uint8_t> chr)
+{
+    if (chr.empty()) {
+        return;
+    }
+
+    for (int tile = 0; tile < tileCount; tile++) {
+        const uint8_t *source = chr.data() + (tile * bytesPerTile) % chr.size();
+        uint8_t *cached = &patterns[tile * bytesPerTile];
+
+        if (std::memcmp(cached, source, bytesPerTile) == 0) {
+            continue;
+        }
+
+        std::memcpy(cached, source, bytesPerTile);
+        decodeTile(tile);
+    }
+}
+
+void TileCache::write(uint16_t address, uint8_t value)
+{
+    address &= 0x1FFF;
+
+    if (patterns[address] != value) {
+        patterns[address] = value;
+        decodeTile(address / bytesPerTile);
+    }
+}
+
+void TileCache::decodeTile(int tile)
+{
+    PixelKernels::decodeTiles(&patterns[tile * bytesPerTile], 1, &pixels[tile * pixelsPerTile], &flippedPixels[tile * pixelsPerTile]);
+}
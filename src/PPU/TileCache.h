@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+/**
+ *  Pattern tables decoded ahead of time to a byte per pixel. CHR stores each row of a tile as two bit planes,
+ *  which would otherwise have to be unpicked for every pixel of every line, so here each row is kept as 8 bytes
+ *  of 2 bit colour, along with a mirrored copy for horizontally flipped sprites. The cache keeps the pattern
+ *  bytes it was decoded from and only re-decodes the tiles which differ when it's updated.
+*/
+
+class TileCache
+{
+public:
+    static constexpr int tileCount = 512;  // Both pattern tables, $0000-$1FFF
+
+    void update(std::span<const uint8_t> chr);  // Mirrored through the pattern tables if it's under 8KB
+    void write(uint16_t address, uint8_t value);
+
+    const uint8_t *getRow(uint16_t patternAddress, bool flipped) const;  // 8 pixels for the tile row at the address
+
+private:
+    static constexpr int bytesPerTile = 16;
+    static constexpr int pixelsPerTile = 64;
+
+    std::array<uint8_t, tileCount * bytesPerTile> patterns {};  // Pattern bytes the pixels were decoded from
+    std::array<uint8_t, tileCount * pixelsPerTile> pixels {};
+    std::array<uint8_t, tileCount * pixelsPerTile> flippedPixels {};
+
+    void decodeTile(int tile);
+};
+
+inline const uint8_t *TileCache::getRow(uint16_t patternAddress, bool flipped) const
+{
+    const int offset = (patternAddress >> 4) * pixelsPerTile + (patternAddress & 0x07) * 8;
+    return flipped ? &flippedPixels[offset] : &pixels[offset];
+}
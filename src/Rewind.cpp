@@ -0,0 +1,295 @@
+#include "Rewind.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "Logger.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define NESBUDDY_REWIND_SSE2
+#endif
+
+/**
+ *  Compressed entries are a list of tokens, each a varint count of unchanged bytes to skip, a varint count of
+ *  changed bytes, then the changed bytes XORed with the reference. Bytes after the last token are unchanged.
+ *  Runs of changes are extended in 16 byte chunks until a whole chunk is unchanged, so the kernels below only
+ *  ever have to look at whole chunks, and each token covers at least 32 bytes of state apart from the last.
+*/
+
+namespace
+{
+    constexpr std::size_t chunkSize = 16;
+    constexpr std::size_t expectedEntrySize = 256;  // Used to share the memory budget between index and data
+
+    // First position at or after position where state and reference differ, or size if there isn't one
+    std::size_t findDifference(const uint8_t *state, const uint8_t *reference, std::size_t position, std::size_t size)
+    {
+#if defined(NESBUDDY_REWIND_SSE2)
+        for (; position + chunkSize <= size; position += chunkSize) {
+            const __m128i stateChunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state + position));
+            const __m128i referenceChunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(reference + position));
+            const unsigned differentBytes = ~_mm_movemask_epi8(_mm_cmpeq_epi8(stateChunk, referenceChunk)) & 0xFFFF;
+
+            if (differentBytes != 0) {
+                return position + std::countr_zero(differentBytes);
+            }
+        }
+#else
+        for (; position + sizeof(uint64_t) <= size; position += sizeof(uint64_t)) {
+            uint64_t stateWord;
+            uint64_t referenceWord;
+            std::memcpy(&stateWord, state + position, sizeof(stateWord));
+            std::memcpy(&referenceWord, reference + position, sizeof(referenceWord));
+
+            if (stateWord != referenceWord) {
+                return position + std::countr_zero(stateWord ^ referenceWord) / 8;
+            }
+        }
+#endif
+
+        for (; position < size; position++) {
+            if (state[position] != reference[position]) {
+                return position;
+            }
+        }
+
+        return size;
+    }
+
+    // Start of the first whole chunk from position on where state and reference are the same, or size
+    std::size_t findUnchangedChunk(const uint8_t *state, const uint8_t *reference, std::size_t position, std::size_t size)
+    {
+        for (; position + chunkSize <= size; position += chunkSize) {
+#if defined(NESBUDDY_REWIND_SSE2)
+            const __m128i stateChunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state + position));
+            const __m128i referenceChunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(reference + position));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(stateChunk, referenceChunk)) == 0xFFFF) {
+                return position;
+            }
+#else
+            if (std::memcmp(state + position, reference + position, chunkSize) == 0) {
+                return position;
+            }
+#endif
+        }
+
+        return size;
+    }
+
+    // output = first ^ second, output may be the same as either input
+    void xorBytes(uint8_t *output, const uint8_t *first, const uint8_t *second, std::size_t size)
+    {
+        std::size_t i = 0;
+
+#if defined(NESBUDDY_REWIND_SSE2)
+        for (; i + chunkSize <= size; i += chunkSize) {
+            const __m128i firstChunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i));
+            const __m128i secondChunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(second + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_xor_si128(firstChunk, secondChunk));
+        }
+#endif
+
+        for (; i < size; i++) {
+            output[i] = first[i] ^ second[i];
+        }
+    }
+
+    uint8_t *writeVarint(uint8_t *output, std::size_t value)
+    {
+        while (value >= 0x80) {
+            *output++ = static_cast<uint8_t>(value) | 0x80;
+            value >>= 7;
+        }
+
+        *output++ = static_cast<uint8_t>(value);
+        return output;
+    }
+
+    const uint8_t *readVarint(const uint8_t *input, std::size_t &value)
+    {
+        value = 0;
+        int shift = 0;
+
+        while (*input & 0x80) {
+            value |= static_cast<std::size_t>(*input++ & 0x7F) << shift;
+            shift += 7;
+        }
+
+        value |= static_cast<std::size_t>(*input++) << shift;
+        return input;
+    }
+}
+
+RewindBuffer::RewindBuffer(std::size_t stateSize, std::size_t memoryBudget, int keyframeInterval)
+    : stateSize(stateSize), keyframeInterval(std::max(keyframeInterval, 1)),
+      keyframe(stateSize), zeros(stateSize), scratch(getMaxCompressedSize(stateSize))
+{
+    const std::size_t entryCapacity = std::max<std::size_t>(memoryBudget / expectedEntrySize, 2);
+    entries.resize(entryCapacity);
+    storage.resize(memoryBudget - std::min(memoryBudget, entryCapacity * sizeof(Entry)));
+}
+
+// Deltas are only taken against a keyframe which is still held, otherwise a new keyframe is started
+void RewindBuffer::capture(std::span<const uint8_t> state)
+{
+    if (state.size() != stateSize) {
+        Logger::printError("Rewind capture doesn't match the state size the buffer was made for.");
+        return;
+    }
+
+    if (entryCount != 0 && framesSinceKeyframe < keyframeInterval) {
+        const std::size_t size = encode(state.data(), keyframe.data(), stateSize, scratch.data());
+
+        if (store(size, false)) {
+            framesSinceKeyframe++;
+            return;
+        }
+    }
+
+    const std::size_t size = encode(state.data(), zeros.data(), stateSize, scratch.data());
+
+    if (store(size, true)) {
+        std::memcpy(keyframe.data(), state.data(), stateSize);
+        framesSinceKeyframe = 1;
+    }
+}
+
+bool RewindBuffer::rewind(std::span<uint8_t> state)
+{
+    if (entryCount == 0 || state.size() != stateSize) {
+        return false;
+    }
+
+    const Entry entry = getEntry(entryCount - 1);
+    decode(storage.data() + entry.offset, entry.size, entry.isKeyframe ? zeros.data() : keyframe.data(), stateSize, state.data());
+
+    entryCount--;
+    usedBytes -= entry.size;
+    writePosition = entry.offset;
+    framesSinceKeyframe--;
+
+    // Steps back to the keyframe before this one, which the remaining deltas were taken against
+    if (entry.isKeyframe && entryCount != 0) {
+        std::size_t index = entryCount - 1;
+        while (!getEntry(index).isKeyframe) {
+            index--;
+        }
+
+        const Entry &previousKeyframe = getEntry(index);
+        decode(storage.data() + previousKeyframe.offset, previousKeyframe.size, zeros.data(), stateSize, keyframe.data());
+        framesSinceKeyframe = static_cast<int>(entryCount - index);
+    }
+
+    return true;
+}
+
+// Copies the entry in scratch into the ring, dropping the oldest entries to make room.
+// Fails for a delta if that would drop its own keyframe.
+bool RewindBuffer::store(std::size_t size, bool isKeyframe)
+{
+    if (size > storage.size()) {
+        Logger::printError("Rewind memory budget is too small for a single state.");
+        return false;
+    }
+
+    // Entries have to be contiguous, so when one doesn't fit before the end of the ring writing wraps to the start.
+    // Anything left at the end from the last time round is older than everything at the start, so it goes first.
+    if (writePosition + size > storage.size()) {
+        while (entryCount != 0 && getEntry(0).offset >= writePosition) {
+            dropOldest();
+        }
+        writePosition = 0;
+    }
+
+    while (entryCount != 0 && getEntry(0).offset >= writePosition && getEntry(0).offset < writePosition + size) {
+        dropOldest();
+    }
+
+    if (entryCount == entries.size()) {
+        dropOldest();
+    }
+
+    if (!isKeyframe && entryCount == 0) {
+        return false;
+    }
+
+    std::memcpy(storage.data() + writePosition, scratch.data(), size);
+
+    entryCount++;
+    getEntry(entryCount - 1) = Entry { static_cast<uint32_t>(writePosition), static_cast<uint32_t>(size), isKeyframe };
+
+    writePosition += size;
+    usedBytes += size;
+
+    return true;
+}
+
+// Deltas can't be decoded without the keyframe before them, so any left at the front go as well
+void RewindBuffer::dropOldest()
+{
+    do {
+        usedBytes -= getEntry(0).size;
+        oldestEntry = (oldestEntry + 1) % entries.size();
+        entryCount--;
+    } while (entryCount != 0 && !getEntry(0).isKeyframe);
+}
+
+RewindBuffer::Entry &RewindBuffer::getEntry(std::size_t index)
+{
+    return entries[(oldestEntry + index) % entries.size()];
+}
+
+// Each token has at most two 10 byte varints, and covers at least 32 bytes apart from the last
+std::size_t RewindBuffer::getMaxCompressedSize(std::size_t stateSize)
+{
+    return stateSize + (stateSize / (2 * chunkSize) + 1) * 20;
+}
+
+std::size_t RewindBuffer::encode(const uint8_t *state, const uint8_t *reference, std::size_t size, uint8_t *output)
+{
+    uint8_t *const start = output;
+    std::size_t position = 0;
+
+    while (true) {
+        const std::size_t changeStart = findDifference(state, reference, position, size);
+
+        if (changeStart == size) {
+            break;
+        }
+
+        const std::size_t changeEnd = findUnchangedChunk(state, reference, changeStart, size);
+
+        output = writeVarint(output, changeStart - position);
+        output = writeVarint(output, changeEnd - changeStart);
+        xorBytes(output, state + changeStart, reference + changeStart, changeEnd - changeStart);
+        output += changeEnd - changeStart;
+
+        position = changeEnd;
+    }
+
+    return output - start;
+}
+
+void RewindBuffer::decode(const uint8_t *input, std::size_t inputSize, const uint8_t *reference, std::size_t size, uint8_t *state)
+{
+    const uint8_t *const end = input + inputSize;
+    std::size_t position = 0;
+
+    std::memcpy(state, reference, size);
+
+    while (input < end) {
+        std::size_t unchanged;
+        std::size_t changed;
+        input = readVarint(input, unchanged);
+        input = readVarint(input, changed);
+
+        position += unchanged;
+        xorBytes(state + position, state + position, input, changed);
+
+        input += changed;
+        position += changed;
+    }
+}
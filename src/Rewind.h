@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ *  Bounded history of savestates for rewinding. Every capture is stored as the XOR of the state against the
+ *  most recent keyframe, which is mostly zeros as little changes from frame to frame, and the zero runs are
+ *  then run length encoded away. Keyframes are stored the same way against an all zero state.
+ *  Entries go into a fixed size ring of bytes, and once it's full the oldest are dropped to make room, along
+ *  with any deltas left without their keyframe. Nothing is allocated after construction.
+*/
+
+class RewindBuffer
+{
+public:
+    // memoryBudget covers both the compressed states and the index of them
+    RewindBuffer(std::size_t stateSize, std::size_t memoryBudget, int keyframeInterval = 60);
+
+    void capture(std::span<const uint8_t> state);
+    bool rewind(std::span<uint8_t> state);  // Restores and removes the newest entry, false once history runs out
+
+    int getFrameCount() const;        // Number of states which can still be rewound through
+    std::size_t getUsedBytes() const; // Compressed bytes held by those states
+
+private:
+    struct Entry
+    {
+        uint32_t offset;
+        uint32_t size;
+        bool isKeyframe;
+    };
+
+    std::size_t stateSize;
+    int keyframeInterval;
+    int framesSinceKeyframe {};
+
+    std::vector<uint8_t> storage;  // Ring of compressed entries, each one contiguous
+    std::size_t writePosition {};
+    std::size_t usedBytes {};
+
+    std::vector<Entry> entries;  // Ring of entries from oldest to newest
+    std::size_t oldestEntry {};
+    std::size_t entryCount {};
+
+    std::vector<uint8_t> keyframe;  // Uncompressed copy of the newest keyframe still held
+    std::vector<uint8_t> zeros;     // Reference keyframes are encoded against
+    std::vector<uint8_t> scratch;   // Compressed entry before it's copied into the ring
+
+    bool store(std::size_t size, bool isKeyframe);
+    void dropOldest();
+    Entry &getEntry(std::size_t index);  // Index 0 is the oldest
+
+    static std::size_t getMaxCompressedSize(std::size_t stateSize);
+    static std::size_t encode(const uint8_t *state, const uint8_t *reference, std::size_t size, uint8_t *output);
+    static void decode(const uint8_t *input, std::size_t inputSize, const uint8_t *reference, std::size_t size, uint8_t *state);
+};
+
+inline int RewindBuffer::getFrameCount() const
+{
+    return static_cast<int>(entryCount);
+}
+
+inline std::size_t RewindBuffer::getUsedBytes() const
+{
+    return usedBytes;
+}
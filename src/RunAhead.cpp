@@ -0,0 +1,52 @@
+#include "RunAhead.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "NES.h"
+
+RunAhead::RunAhead(NES &nes, int frames) : nes(nes), frames(std::max(frames, 0)), snapshot(nes.getSaveStateSize())
+{
+}
+
+void RunAhead::setFrames(int frames)
+{
+    this->frames = std::max(frames, 0);
+}
+
+void RunAhead::runFrame()
+{
+    if (frames == 0) {
+        nes.setOutputEnabled(true);
+        nes.runFrame();
+        lastExtraMicroseconds = 0.0;
+        framesRun++;
+        return;
+    }
+
+    nes.setOutputEnabled(false);
+    nes.runFrame();
+
+    const auto extraStart = std::chrono::steady_clock::now();
+
+    nes.saveState(snapshot);
+
+    const uint64_t snapshotInstructionCount = nes.getInstructionCount();
+    const uint64_t snapshotCycleCount = nes.getCycleCount();
+
+    for (int i = 0; i < frames; i++) {
+        nes.setOutputEnabled(i == frames - 1);
+        nes.runFrame();
+    }
+
+    extraInstructionCount += nes.getInstructionCount() - snapshotInstructionCount;
+    extraCycleCount += nes.getCycleCount() - snapshotCycleCount;
+
+    nes.loadState(snapshot);
+    nes.setOutputEnabled(true);
+
+    const std::chrono::duration<double, std::micro> extraTime = std::chrono::steady_clock::now() - extraStart;
+    lastExtraMicroseconds = extraTime.count();
+    totalExtraMicroseconds += lastExtraMicroseconds;
+    framesRun++;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class NES;
+
+/**
+ *  Hides the frames of input lag games build in by running ahead of the real emulation. Each host frame runs
+ *  one real frame, snapshots the console, runs the given number of frames further with the same input and
+ *  shows the last of them, then loads the snapshot back. Only the shown frame generates video and audio.
+ *  With 0 frames it just runs frames as normal.
+*/
+
+class RunAhead
+{
+public:
+    RunAhead(NES &nes, int frames);
+
+    void setFrames(int frames);
+    int getFrames() const;
+
+    void runFrame();
+
+    // Time spent on snapshots and the extra frames, on top of the real frame
+    double getLastExtraMicroseconds() const;
+    double getAverageExtraMicroseconds() const;
+
+    // Work done in the extra frames, which loading the snapshot takes back off the console's own counters
+    uint64_t getExtraInstructionCount() const;
+    uint64_t getExtraCycleCount() const;
+
+private:
+    NES &nes;
+    int frames;
+
+    std::vector<uint8_t> snapshot;
+
+    double lastExtraMicroseconds {};
+    double totalExtraMicroseconds {};
+    uint64_t framesRun {};
+
+    uint64_t extraInstructionCount {};
+    uint64_t extraCycleCount {};
+};
+
+inline int RunAhead::getFrames() const
+{
+    return frames;
+}
+
+inline double RunAhead::getLastExtraMicroseconds() const
+{
+    return lastExtraMicroseconds;
+}
+
+inline double RunAhead::getAverageExtraMicroseconds() const
+{
+    return framesRun != 0 ? totalExtraMicroseconds / framesRun : 0.0;
+}
+
+inline uint64_t RunAhead::getExtraInstructionCount() const
+{
+    return extraInstructionCount;
+}
+
+inline uint64_t RunAhead::getExtraCycleCount() const
+{
+    return extraCycleCount;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+/**
+ *  Fixed size lock-free queue with exactly one thread pushing and one thread popping.
+ *  Capacity has to be a power of two, and one slot is always left empty to tell a full queue from an empty one.
+*/
+
+template <typename T, std::size_t Capacity>
+class SPSCQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool push(const T &value);  // Returns false if the queue is full
+    std::optional<T> pop();     // Returns nullopt if the queue is empty
+
+private:
+    std::array<T, Capacity> slots {};
+
+    alignas(64) std::atomic<std::size_t> head { 0 };  // Next slot to pop, written by the consumer
+    alignas(64) std::atomic<std::size_t> tail { 0 };  // Next slot to push, written by the producer
+};
+
+template <typename T, std::size_t Capacity>
+bool SPSCQueue<T, Capacity>::push(const T &value)
+{
+    const std::size_t currentTail = tail.load(std::memory_order_relaxed);
+    const std::size_t nextTail = (currentTail + 1) & (Capacity - 1);
+
+    if (nextTail == head.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    slots[currentTail] = value;
+    tail.store(nextTail, std::memory_order_release);
+    return true;
+}
+
+template <typename T, std::size_t Capacity>
+std::optional<T> SPSCQueue<T, Capacity>::pop()
+{
+    const std::size_t currentHead = head.load(std::memory_order_relaxed);
+
+    if (currentHead == tail.load(std::memory_order_acquire)) {
+        return std::nullopt;
+    }
+
+    T value = slots[currentHead];
+    head.store((currentHead + 1) & (Capacity - 1), std::memory_order_release);
+    return value;
+}
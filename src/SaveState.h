@@ -0,0 +1,117 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+/**
+ *  Binary savestate layout. A state is a Header followed by each component's fields in a fixed order, written
+ *  field by field with no padding, so states can be compared byte for byte. The size only depends on the
+ *  cartridge (through its PRG-RAM and CHR-RAM), which lets callers size a buffer once and reuse it.
+ *  Bump version whenever any component changes what it writes.
+*/
+
+static_assert(std::endian::native == std::endian::little, "Savestates are stored little endian");
+
+namespace SaveState
+{
+    constexpr char magic[4] = { 'N', 'B', 'S', 'S' };
+    constexpr uint32_t version = 2;
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t size;     // Size of the whole state, header included
+        uint32_t reserved;
+        uint64_t romHash;  // ROMImage hash of the cartridge the state was saved from
+    };
+
+    static_assert(sizeof(Header) == 24);
+
+    // Writes fields into a caller provided buffer. Running out of space stops the writing but keeps counting,
+    // so writing into an empty buffer measures the size needed.
+    class Writer
+    {
+    public:
+        explicit Writer(std::span<uint8_t> buffer) : buffer(buffer) {}
+
+        template <typename T>
+        void write(const T &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            writeBytes(&value, sizeof(value));
+        }
+
+        void writeBytes(const void *data, std::size_t size)
+        {
+            if (position + size <= buffer.size()) {
+                std::memcpy(buffer.data() + position, data, size);
+            } else {
+                overflowed = true;
+            }
+
+            position += size;
+        }
+
+        std::size_t getSize() const
+        {
+            return position;
+        }
+
+        bool hasOverflowed() const
+        {
+            return overflowed;
+        }
+
+    private:
+        std::span<uint8_t> buffer;
+        std::size_t position {};
+        bool overflowed {};
+    };
+
+    // Reads fields back in the order they were written. Reading past the end leaves values untouched.
+    class Reader
+    {
+    public:
+        explicit Reader(std::span<const uint8_t> buffer) : buffer(buffer) {}
+
+        template <typename T>
+        void read(T &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+
+            if constexpr (std::is_same_v<T, bool>) {
+                uint8_t byte = value;
+                readBytes(&byte, sizeof(byte));
+                value = byte != 0;
+            } else {
+                readBytes(&value, sizeof(value));
+            }
+        }
+
+        void readBytes(void *data, std::size_t size)
+        {
+            if (position + size <= buffer.size()) {
+                std::memcpy(data, buffer.data() + position, size);
+            } else {
+                overflowed = true;
+            }
+
+            position += size;
+        }
+
+        bool hasOverflowed() const
+        {
+            return overflowed;
+        }
+
+    private:
+        std::span<const uint8_t> buffer;
+        std::size_t position {};
+        bool overflowed {};
+    };
+}
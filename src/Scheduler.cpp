@@ -0,0 +1,96 @@
+#include "Scheduler.h"
+
+void Scheduler::schedule(ScheduledEvent event, uint64_t cycle)
+{
+    cancel(event);
+
+    const Entry entry { cycle, event };
+
+    // Entries are sorted latest first, so find the first one which runs before the new event
+    int position = 0;
+    while (position < entryCount && !runsBefore(entries[position], entry)) {
+        position++;
+    }
+
+    for (int i = entryCount; i > position; i--) {
+        entries[i] = entries[i - 1];
+    }
+
+    entries[position] = entry;
+    entryCount++;
+}
+
+void Scheduler::cancel(ScheduledEvent event)
+{
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].event == event) {
+            for (int j = i; j < entryCount - 1; j++) {
+                entries[j] = entries[j + 1];
+            }
+
+            entryCount--;
+            return;
+        }
+    }
+}
+
+void Scheduler::clear()
+{
+    entryCount = 0;
+}
+
+bool Scheduler::isScheduled(ScheduledEvent event) const
+{
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].event == event) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Removes and returns the soonest event if it is due by currentCycle
+std::optional<ScheduledEvent> Scheduler::popDueEvent(uint64_t currentCycle)
+{
+    if (entryCount == 0 || entries[entryCount - 1].cycle > currentCycle) {
+        return std::nullopt;
+    }
+
+    entryCount--;
+    return entries[entryCount].event;
+}
+
+// Saved as the cycle each event type is due on, or noEvent, so the layout doesn't depend on the queue's order
+void Scheduler::saveState(SaveState::Writer &writer) const
+{
+    std::array<uint64_t, static_cast<int>(ScheduledEvent::count)> eventCycles;
+    eventCycles.fill(noEvent);
+
+    for (int i = 0; i < entryCount; i++) {
+        eventCycles[static_cast<int>(entries[i].event)] = entries[i].cycle;
+    }
+
+    writer.write(eventCycles);
+}
+
+void Scheduler::loadState(SaveState::Reader &reader)
+{
+    std::array<uint64_t, static_cast<int>(ScheduledEvent::count)> eventCycles;
+    eventCycles.fill(noEvent);
+    reader.read(eventCycles);
+
+    clear();
+
+    for (int event = 0; event < static_cast<int>(ScheduledEvent::count); event++) {
+        if (eventCycles[event] != noEvent) {
+            schedule(static_cast<ScheduledEvent>(event), eventCycles[event]);
+        }
+    }
+}
+
+// Events due on the same cycle run in the order they're declared in ScheduledEvent
+bool Scheduler::runsBefore(const Entry &first, const Entry &second)
+{
+    return first.cycle < second.cycle || (first.cycle == second.cycle && first.event < second.event);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "SaveState.h"
+
+enum class ScheduledEvent : uint8_t
+{
+    vblank,       // PPU enters vertical blank, which raises NMI if it is enabled
+    vblankEnd,    // PPU reaches the pre-render scanline, which clears the vblank flag
+    apuFrameIrq,  // APU frame counter interrupt
+    mapperIrq,    // Scanline or cycle counter interrupt on the cartridge
+    count
+};
+
+/**
+ *  Timestamped queue of upcoming events, keyed on the CPU cycle counter. The CPU runs uninterrupted up to
+ *  getNextEventCycle() and events are only looked at once it gets there, instead of every component being
+ *  polled after every instruction. Each event type is pending at most once, so the queue is a small array
+ *  kept sorted with the soonest event at the back.
+*/
+
+class Scheduler
+{
+public:
+    static constexpr uint64_t noEvent = std::numeric_limits<uint64_t>::max();
+
+    void schedule(ScheduledEvent event, uint64_t cycle);  // Replaces the event if it's already pending
+    void cancel(ScheduledEvent event);
+    void clear();
+
+    bool isScheduled(ScheduledEvent event) const;
+    uint64_t getNextEventCycle() const;
+    std::optional<ScheduledEvent> popDueEvent(uint64_t currentCycle);
+
+    void saveState(SaveState::Writer &writer) const;
+    void loadState(SaveState::Reader &reader);
+
+private:
+    struct Entry
+    {
+        uint64_t cycle;
+        ScheduledEvent event;
+    };
+
+    std::array<Entry, static_cast<int>(ScheduledEvent::count)> entries {};
+    int entryCount {};
+
+    static bool runsBefore(const Entry &first, const Entry &second);
+};
+
+inline uint64_t Scheduler::getNextEventCycle() const
+{
+    return entryCount != 0 ? entries[entryCount - 1].cycle : noEvent;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ *  Lock-free handoff of the latest value from one producer thread to one consumer thread. The producer always
+ *  has a buffer of its own to write into and the consumer always has the last one it took, with the third
+ *  buffer in between holding whatever was published most recently. Neither side ever waits for the other,
+ *  and a consumer which falls behind just skips to the newest value.
+*/
+
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Producer side
+    T &getWriteBuffer();
+    void publish();
+
+    // Consumer side. Returns nullptr if nothing has been published since the last call, otherwise the
+    // newest value, which stays valid until the next call.
+    const T *consume();
+
+private:
+    static constexpr uint8_t indexMask = 0x03;
+    static constexpr uint8_t freshBit = 0x04;  // Set on the middle index when it holds an unconsumed value
+
+    std::array<T, 3> buffers {};
+
+    // Kept on separate cache lines so the two threads don't keep taking the line off each other
+    alignas(64) std::atomic<uint8_t> middle { 0 };
+    alignas(64) uint8_t back { 1 };   // Only touched by the producer
+    alignas(64) uint8_t front { 2 };  // Only touched by the consumer
+};
+
+template <typename T>
+inline T &TripleBuffer<T>::getWriteBuffer()
+{
+    return buffers[back];
+}
+
+template <typename T>
+inline void TripleBuffer<T>::publish()
+{
+    back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+}
+
+template <typename T>
+inline const T *TripleBuffer<T>::consume()
+{
+    if ((middle.load(std::memory_order_relaxed) & freshBit) == 0) {
+        return nullptr;
+    }
+
+    front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+    return &buffers[front];
+}
@@ -1,26 +1,181 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
 #include <SDL.h>
+#include <fmt/core.h>
 
 #include "Application.h"
+#include "EmulationThread.h"
 #include "Logger.h"
 #include "NES.h"
+#include "RunAhead.h"
+
+namespace
+{
+    struct Options
+    {
+        bool headless {};
+        std::optional<std::string> romPath;
+        uint64_t frames { 600 };
+        std::string backend { "jit" };  // interpreter, cache or jit
+        int runAheadFrames {};
+    };
+
+    void printUsage()
+    {
+        fmt::print("Usage: nesbuddy [--rom path.nes] [--headless] [--frames N] [--backend interpreter|cache|jit] [--run-ahead N]\n");
+    }
+
+    // Returns nullopt if the arguments are invalid
+    std::optional<Options> parseArguments(int argc, char *argv[])
+    {
+        Options options;
+
+        for (int i = 1; i < argc; i++) {
+            const std::string_view argument = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (argument == "--headless") {
+                options.headless = true;
+            } else if (argument == "--rom" && hasValue) {
+                options.romPath = argv[++i];
+            } else if (argument == "--frames" && hasValue) {
+                char *end = nullptr;
+                options.frames = std::strtoull(argv[++i], &end, 10);
+
+                if (*end != '\0' || options.frames == 0) {
+                    Logger::printError("--frames needs a positive whole number.");
+                    return std::nullopt;
+                }
+            } else if (argument == "--run-ahead" && hasValue) {
+                char *end = nullptr;
+                options.runAheadFrames = static_cast<int>(std::strtol(argv[++i], &end, 10));
+
+                if (*end != '\0' || options.runAheadFrames < 0 || options.runAheadFrames > 8) {
+                    Logger::printError("--run-ahead needs a number of frames from 0 to 8.");
+                    return std::nullopt;
+                }
+            } else if (argument == "--backend" && hasValue) {
+                options.backend = argv[++i];
+
+                if (options.backend != "interpreter" && options.backend != "cache" && options.backend != "jit") {
+                    Logger::printError("Unknown backend: " + options.backend);
+                    return std::nullopt;
+                }
+            } else {
+                Logger::printError("Unrecognised argument: " + std::string(argument));
+                return std::nullopt;
+            }
+        }
+
+        if (options.headless && !options.romPath.has_value()) {
+            Logger::printError("--headless needs a ROM given with --rom.");
+            return std::nullopt;
+        }
+
+        return options;
+    }
+
+    void selectBackend(NES &nes, const std::string &backend)
+    {
+        if (backend == "jit") {
+            nes.setJITEnabled(true);
+        } else if (backend == "cache") {
+            nes.setBlockCacheEnabled(true);
+        }
+    }
+
+    // Runs the core flat out with no window or file dialog and reports its throughput
+    void runHeadless(const Options &options)
+    {
+        NES nes(*options.romPath);
+        selectBackend(nes, options.backend);
+
+        RunAhead runAhead(nes, options.runAheadFrames);
+
+        const auto startTime = std::chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < options.frames; i++) {
+            runAhead.runFrame();
+        }
+
+        const std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - startTime;
+        const double seconds = wallTime.count();
+
+        fmt::print("Backend:        {}\n", options.backend);
+        fmt::print("Frames:         {}\n", options.frames);
+        fmt::print("Wall time:      {:.3f} s\n", seconds);
+        fmt::print("Frames/s:       {:.2f}\n", options.frames / seconds);
+        // Includes the frames run ahead, which are rolled back off the console's own counters
+        const uint64_t instructions = nes.getInstructionCount() + runAhead.getExtraInstructionCount();
+        const uint64_t cycles = nes.getCycleCount() + runAhead.getExtraCycleCount();
+
+        fmt::print("Instructions/s: {:.2f} M\n", instructions / seconds / 1e6);
+        fmt::print("Cycles/s:       {:.2f} M\n", cycles / seconds / 1e6);
+
+        if (options.runAheadFrames != 0) {
+            const double extraMicroseconds = runAhead.getAverageExtraMicroseconds();
+            const double frameRate = nes.getFrameRate();
+            const double frameMicroseconds = 1e6 / frameRate;
+
+            fmt::print("Run-ahead:      {} frames, {:.1f} us extra per frame ({:.1f}% of a {:.0f}Hz frame)\n",
+                       options.runAheadFrames, extraMicroseconds, extraMicroseconds / frameMicroseconds * 100, frameRate);
+        }
+    }
+}
 
 int main(int argc, char *argv[])
 {
+    const std::optional<Options> options = parseArguments(argc, argv);
+
+    if (!options.has_value()) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
     try {
+        if (options->headless) {
+            runHeadless(*options);
+            return EXIT_SUCCESS;
+        }
+
         Application application;
 
-        NES nes;
+        // Without a ROM path the NES asks for one with a file dialog
+        std::unique_ptr<NES> nes = options->romPath.has_value() ? std::make_unique<NES>(*options->romPath) : std::make_unique<NES>();
+        selectBackend(*nes, options->backend);
+
+        EmulationThread emulation(*nes, options->runAheadFrames);
 
         bool isRunning = true;
+        uint8_t sentButtons = 0;
 
+        // Nothing here waits on the emulation thread. Input goes over whenever it changes, and the screen is
+        // only redrawn when a new frame has finished, otherwise the loop just goes back to polling.
         while (isRunning) {
             application.pollEvents(isRunning);
-            application.updateScreen();
+
+            const uint8_t buttons = application.getControllerButtons();
+
+            if (buttons != sentButtons && emulation.pushInput(InputEvent { 0, buttons })) {
+                sentButtons = buttons;
+            }
+
+            if (const Frame *frame = emulation.takeFrame()) {
+                application.updateScreen(frame->pixels);
+            } else {
+                SDL_Delay(1);
+            }
         }
     } catch (std::exception const &e) {
         Logger::printError(e.what());
         return EXIT_FAILURE;
     }
-    
+
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+/**
+ *  Packed binary form of the SingleStepTests JSON files, written once by convert_tests and then mapped straight
+ *  into memory by cputest. Each file is a FileHeader followed by caseCount records, each of which is a
+ *  CaseHeader followed by its initial RAM, final RAM and bus cycle entries and then its name, padded to a multiple
+ *  of 4 bytes. Everything is little endian and naturally aligned, so records can be read in place.
+*/
+
+static_assert(std::endian::native == std::endian::little, "Packed test vectors are stored little endian");
+
+namespace TestVectors
+{
+    constexpr char magic[4] = { 'N', 'B', 'T', 'V' };
+    constexpr uint32_t version = 1;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t caseCount;
+        uint32_t reserved;
+    };
+
+    struct PackedState
+    {
+        uint16_t pc;
+        uint8_t sp;
+        uint8_t accumulator;
+        uint8_t indexX;
+        uint8_t indexY;
+        uint8_t processorStatus;
+        uint8_t padding;
+    };
+
+    struct RAMEntry
+    {
+        uint16_t address;
+        uint8_t value;
+        uint8_t padding;
+    };
+
+    struct BusCycle
+    {
+        uint16_t address;
+        uint8_t value;
+        uint8_t isWrite;
+    };
+
+    struct CaseHeader
+    {
+        PackedState initial;
+        PackedState final;
+        uint16_t initialRAMCount;
+        uint16_t finalRAMCount;
+        uint16_t cycleCount;
+        uint16_t nameLength;
+    };
+
+    static_assert(sizeof(FileHeader) == 16 && sizeof(PackedState) == 8 && sizeof(RAMEntry) == 4
+                  && sizeof(BusCycle) == 4 && sizeof(CaseHeader) == 24);
+
+    constexpr std::size_t paddedNameLength(std::size_t nameLength)
+    {
+        return (nameLength + 3) & ~std::size_t { 3 };
+    }
+
+    // Views into a single record of a mapped file
+    struct TestCase
+    {
+        const CaseHeader *header;
+        const RAMEntry *initialRAM;
+        const RAMEntry *finalRAM;
+        const BusCycle *cycles;
+        std::string_view name;
+    };
+
+    // Walks the records of a packed file without copying or allocating
+    class Reader
+    {
+    public:
+        // Returns nullopt if the data isn't a packed test vector file of the current version
+        static std::optional<Reader> open(const uint8_t *data, std::size_t size)
+        {
+            FileHeader header;
+
+            if (size < sizeof(header)) {
+                return std::nullopt;
+            }
+
+            std::memcpy(&header, data, sizeof(header));
+
+            if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version) {
+                return std::nullopt;
+            }
+
+            return Reader(data + sizeof(header), data + size, header.caseCount);
+        }
+
+        // Reads the records between start and end, which have to fall on record boundaries
+        Reader(const uint8_t *start, const uint8_t *end, uint32_t caseCount)
+            : position(start), end(end), caseCount(caseCount) {}
+
+        uint32_t getCaseCount() const
+        {
+            return caseCount;
+        }
+
+        // Start of the next record, which can be used to split a file into separately read ranges
+        const uint8_t *getPosition() const
+        {
+            return position;
+        }
+
+        // Returns nullopt once every case has been read, or if the file is truncated
+        std::optional<TestCase> next()
+        {
+            if (position + sizeof(CaseHeader) > end) {
+                return std::nullopt;
+            }
+
+            TestCase testCase;
+            testCase.header = reinterpret_cast<const CaseHeader *>(position);
+
+            const std::size_t entriesSize = (testCase.header->initialRAMCount + testCase.header->finalRAMCount) * sizeof(RAMEntry)
+                                          + testCase.header->cycleCount * sizeof(BusCycle);
+            const std::size_t recordSize = sizeof(CaseHeader) + entriesSize + paddedNameLength(testCase.header->nameLength);
+
+            if (position + recordSize > end) {
+                return std::nullopt;
+            }
+
+            testCase.initialRAM = reinterpret_cast<const RAMEntry *>(position + sizeof(CaseHeader));
+            testCase.finalRAM = testCase.initialRAM + testCase.header->initialRAMCount;
+            testCase.cycles = reinterpret_cast<const BusCycle *>(testCase.finalRAM + testCase.header->finalRAMCount);
+            testCase.name = std::string_view(reinterpret_cast<const char *>(position + sizeof(CaseHeader) + entriesSize),
+                                             testCase.header->nameLength);
+
+            position += recordSize;
+            return testCase;
+        }
+
+    private:
+        const uint8_t *position;
+        const uint8_t *end;
+        uint32_t caseCount;
+    };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+/**
+ *  Runs a fixed set of tasks across a group of threads. Each worker starts with its own contiguous run of tasks
+ *  and takes from the front of it, and once it runs out it steals from the back of another worker's run, so
+ *  uneven tasks still keep every thread busy. No tasks are added while running, so a worker which finds every
+ *  queue empty is finished.
+*/
+
+class WorkStealingPool
+{
+public:
+    explicit WorkStealingPool(int threadCount) : threadCount(threadCount > 0 ? threadCount : 1) {}
+
+    int getThreadCount() const
+    {
+        return threadCount;
+    }
+
+    // Calls task(taskIndex, workerIndex) once for every task and returns when they've all finished.
+    // workerIndex lets tasks reuse per-thread state without any locking.
+    void run(std::size_t taskCount, const std::function<void(std::size_t, int)> &task)
+    {
+        std::vector<WorkerQueue> queues(threadCount);
+
+        for (int worker = 0; worker < threadCount; worker++) {
+            const std::size_t first = taskCount * worker / threadCount;
+            const std::size_t last = taskCount * (worker + 1) / threadCount;
+
+            for (std::size_t i = first; i < last; i++) {
+                queues[worker].tasks.push_back(i);
+            }
+        }
+
+        std::vector<std::thread> threads;
+
+        for (int worker = 0; worker < threadCount; worker++) {
+            threads.emplace_back([&queues, &task, worker, this]() {
+                while (std::optional<std::size_t> taskIndex = takeTask(queues, worker)) {
+                    task(*taskIndex, worker);
+                }
+            });
+        }
+
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    int threadCount;
+
+    std::optional<std::size_t> takeTask(std::vector<WorkerQueue> &queues, int worker)
+    {
+        {
+            std::lock_guard lock(queues[worker].mutex);
+
+            if (!queues[worker].tasks.empty()) {
+                const std::size_t taskIndex = queues[worker].tasks.front();
+                queues[worker].tasks.pop_front();
+                return taskIndex;
+            }
+        }
+
+        for (int offset = 1; offset < threadCount; offset++) {
+            WorkerQueue &victim = queues[(worker + offset) % threadCount];
+            std::lock_guard lock(victim.mutex);
+
+            if (!victim.tasks.empty()) {
+                const std::size_t taskIndex = victim.tasks.back();
+                victim.tasks.pop_back();
+                return taskIndex;
+            }
+        }
+
+        return std::nullopt;
+    }
+};
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include "TestVectors.h"
+
+/**
+ *  Converts SingleStepTests JSON files into the packed format read by cputest, writing a .bin file next to each
+ *  .json file. Run it once over the tests directory: convert_tests ./tests
+*/
+
+using json = nlohmann::json;
+
+namespace
+{
+    template <typename T>
+    void writeValue(std::ofstream &output, const T &value)
+    {
+        output.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    TestVectors::PackedState packState(const json &state)
+    {
+        TestVectors::PackedState packed {};
+        packed.pc              = state["pc"];
+        packed.sp              = state["s"];
+        packed.accumulator     = state["a"];
+        packed.indexX          = state["x"];
+        packed.indexY          = state["y"];
+        packed.processorStatus = state["p"];
+        return packed;
+    }
+
+    void writeRAM(std::ofstream &output, const json &ram)
+    {
+        for (const auto &ramItem : ram) {
+            writeValue(output, TestVectors::RAMEntry { ramItem[0], ramItem[1], 0 });
+        }
+    }
+
+    bool convertFile(const std::filesystem::path &jsonPath)
+    {
+        std::ifstream input(jsonPath);
+        const json tests = json::parse(input, nullptr, false);
+
+        if (tests.is_discarded() || !tests.is_array()) {
+            fmt::print(stderr, "Skipping {}: not a JSON array of tests\n", jsonPath.string());
+            return false;
+        }
+
+        std::filesystem::path binaryPath = jsonPath;
+        binaryPath.replace_extension(".bin");
+
+        std::ofstream output(binaryPath, std::ios::binary);
+
+        TestVectors::FileHeader fileHeader {};
+        std::copy(std::begin(TestVectors::magic), std::end(TestVectors::magic), fileHeader.magic);
+        fileHeader.version = TestVectors::version;
+        fileHeader.caseCount = static_cast<uint32_t>(tests.size());
+        writeValue(output, fileHeader);
+
+        for (const auto &test : tests) {
+            const std::string name = test["name"];
+
+            TestVectors::CaseHeader caseHeader {};
+            caseHeader.initial = packState(test["initial"]);
+            caseHeader.final = packState(test["final"]);
+            caseHeader.initialRAMCount = static_cast<uint16_t>(test["initial"]["ram"].size());
+            caseHeader.finalRAMCount = static_cast<uint16_t>(test["final"]["ram"].size());
+            caseHeader.cycleCount = static_cast<uint16_t>(test["cycles"].size());
+            caseHeader.nameLength = static_cast<uint16_t>(name.size());
+            writeValue(output, caseHeader);
+
+            writeRAM(output, test["initial"]["ram"]);
+            writeRAM(output, test["final"]["ram"]);
+
+            for (const auto &cycle : test["cycles"]) {
+                const uint8_t isWrite = cycle[2] == "write";
+                writeValue(output, TestVectors::BusCycle { cycle[0], cycle[1], isWrite });
+            }
+
+            output.write(name.data(), name.size());
+            output.write("\0\0\0", TestVectors::paddedNameLength(name.size()) - name.size());
+        }
+
+        if (!output) {
+            fmt::print(stderr, "Failed to write {}\n", binaryPath.string());
+            return false;
+        }
+
+        fmt::print("{} -> {} ({} tests)\n", jsonPath.string(), binaryPath.string(), tests.size());
+        return true;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fmt::print(stderr, "Usage: convert_tests <directory or .json file>...\n");
+        return EXIT_FAILURE;
+    }
+
+    bool allConverted = true;
+
+    for (int i = 1; i < argc; i++) {
+        const std::filesystem::path path = argv[i];
+
+        if (std::filesystem::is_directory(path)) {
+            for (const auto &entry : std::filesystem::directory_iterator(path)) {
+                if (entry.path().extension() == ".json") {
+                    allConverted &= convertFile(entry.path());
+                }
+            }
+        } else {
+            allConverted &= convertFile(path);
+        }
+    }
+
+    return allConverted ? EXIT_SUCCESS : EXIT_FAILURE;
+}
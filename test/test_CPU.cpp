@@ -1,245 +1,804 @@
+#include <algorithm>
+#include <array>
+#include <filesystem>
 #include <format>
-#include <fstream>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
-#include <nlohmann/json.hpp>
 
+#include "../src/CPU/CPU.h"
 #include "../src/CPU/State.h"
-#include "../src/NES.h"
+#include "../src/FlatBus.h"
+#include "../src/MappedFile.h"
+#include "../src/MemoryMap.h"
+#include "TestVectors.h"
+#include "WorkStealingPool.h"
 
-using json = nlohmann::json;
+namespace
+{
+    CPUState unpackState(const TestVectors::PackedState &packed)
+    {
+        CPUState state;
+        state.accumulator     = packed.accumulator;
+        state.pc              = packed.pc;
+        state.sp              = packed.sp;
+        state.indexX          = packed.indexX;
+        state.indexY          = packed.indexY;
+        state.processorStatus = packed.processorStatus;
+        return state;
+    }
+
+    // 2KB of RAM mirrored four times through $0000-$1FFF like the NES, with nothing else mapped in
+    class MirroredRAMBus
+    {
+    public:
+        MirroredRAMBus()
+        {
+            for (uint16_t mirror = 0x0000; mirror < 0x2000; mirror += 0x800) {
+                memoryMap.mapRead(mirror, 0x800, ram.data());
+                memoryMap.mapWrite(mirror, 0x800, ram.data());
+            }
+        }
+
+        uint8_t memoryRead(uint16_t address)
+        {
+            return address < 0x2000 ? ram[address & 0x7FF] : 0;
+        }
+
+        void memoryWrite(uint16_t address, uint8_t value)
+        {
+            if (address < 0x2000) {
+                ram[address & 0x7FF] = value;
+            }
+        }
+
+        const uint8_t *getCodePointer(uint16_t address)
+        {
+            const uint8_t *page = memoryMap.getReadPage(address);
+            return page != nullptr ? page + (address & 0xFF) : nullptr;
+        }
+
+        const MemoryMap &getMemoryMap()
+        {
+            return memoryMap;
+        }
+
+    private:
+        std::array<uint8_t, 0x800> ram {};
+        MemoryMap memoryMap;
+    };
+
+    // Adds registers at $2000-$3FFF which record the cycle of every access, as the PPU needs to know it
+    class TimestampBus : public MirroredRAMBus
+    {
+    public:
+        struct Access
+        {
+            uint16_t address;
+            uint64_t cycle;
+
+            bool operator==(const Access &) const = default;
+        };
+
+        CPU<TimestampBus> *cpu {};
+        std::vector<Access> accesses;
+
+        uint8_t memoryRead(uint16_t address)
+        {
+            if (address >= 0x2000 && address < 0x4000) {
+                accesses.push_back({ address, cpu->getCurrentCycle() });
+                return 0;
+            }
+
+            return MirroredRAMBus::memoryRead(address);
+        }
+
+        void memoryWrite(uint16_t address, uint8_t value)
+        {
+            if (address >= 0x2000 && address < 0x4000) {
+                accesses.push_back({ address, cpu->getCurrentCycle() });
+                return;
+            }
+
+            MirroredRAMBus::memoryWrite(address, value);
+        }
+    };
+}
+
+// Runs a single test vector, either through the interpreter or as a block compiled by the JIT, and returns a
+// description of what went wrong if it failed. The bus and CPU are reused from one test to the next.
+std::optional<std::string> runOpcodeTest(const TestVectors::TestCase &test, FlatBus &bus, CPU<FlatBus> &cpu, bool useJIT)
+{
+    const TestVectors::CaseHeader &header = *test.header;
+
+    cpu.setState(unpackState(header.initial));
+
+    // Set memory to initial values
+    for (int i = 0; i < header.initialRAMCount; i++) {
+        bus.memoryWrite(test.initialRAM[i].address, test.initialRAM[i].value);
+    }
+
+    // Run CPU for the given instruction
+#if defined(NESBUDDY_JIT_SUPPORTED)
+    int cycles = useJIT ? cpu.tickWithJIT() : cpu.tick();
+#else
+    int cycles = cpu.tick();
+#endif
+
+    // Get the final state of the CPU and the expected state
+    CPUState endCPUState = cpu.getState();
+    CPUState expectedCPUState = unpackState(header.final);
+
+    // Check if memory contents equal expected values
+    bool ramMatch = true;
+    for (int i = 0; i < header.finalRAMCount; i++) {
+        if (bus.memoryRead(test.finalRAM[i].address) != test.finalRAM[i].value) {
+            ramMatch = false;
+        }
+    }
+
+    std::optional<std::string> failure;
+
+    // Messages are only put together for failing tests, doing it for every test would dominate the run time
+    if (!(expectedCPUState == endCPUState) || !ramMatch || cycles != header.cycleCount) {
+        std::ostringstream message;
+        message << "Operation: \"" << test.name << "\"" << (useJIT ? " (JIT)" : "") << "\n";
+        message << "Expected CPU State:\n\t" << expectedCPUState.toString() << "\nActual CPU State:\n\t" << endCPUState.toString() << "\n";
+        message << "Expected Cycles: " << header.cycleCount << " Actual Cycles: " << cycles << "\n";
+
+        message << "Expected Memory State:\n";
+        for (int i = 0; i < header.finalRAMCount; i++) {
+            message << "\tAddr: " << test.finalRAM[i].address << " Val: " << +test.finalRAM[i].value << "\n";
+        }
+
+        message << "Actual Memory State:\n";
+        for (int i = 0; i < header.finalRAMCount; i++) {
+            message << "\tAddr: " << test.finalRAM[i].address << " Val: " << +bus.memoryRead(test.finalRAM[i].address) << "\n";
+        }
+
+        failure = message.str();
+    }
 
-// Indexes for accessing address/value items from JSON documents
-constexpr int address = 0;
-constexpr int value   = 1;
+    // Clear everything the test touched, ready for the next one
+    bus.reset();
 
+    return failure;
+}
+
+// Buses and CPUs for running test vectors through every backend, created once and reused for every test
+struct OpcodeTestRunner
+{
+    FlatBus bus;
+    CPU<FlatBus> cpu;
+#if defined(NESBUDDY_JIT_SUPPORTED)
+    FlatBus jitBus;
+    CPU<FlatBus> jitCPU;
+#endif
+
+    OpcodeTestRunner()
+    {
+        cpu.connectToBus(&bus);
+#if defined(NESBUDDY_JIT_SUPPORTED)
+        jitCPU.connectToBus(&jitBus);
+        jitCPU.setJITEnabled(true);
+#endif
+    }
+
+    // Returns the first failure out of the backends
+    std::optional<std::string> run(const TestVectors::TestCase &test)
+    {
+        std::optional<std::string> failure = runOpcodeTest(test, bus, cpu, false);
+#if defined(NESBUDDY_JIT_SUPPORTED)
+        if (!failure.has_value()) {
+            failure = runOpcodeTest(test, jitBus, jitCPU, true);
+        }
+#endif
+        return failure;
+    }
+};
+
+// Test files are the packed .bin files written by convert_tests from the SingleStepTests JSON files
 void testOpcode(std::string_view testFileName)
 {
-    std::ifstream f(std::format("./tests/{}", testFileName));
+    const MappedFile file(std::format("./tests/{}", testFileName));
 
-    json tests = json::parse(f);
+    std::optional<TestVectors::Reader> reader = TestVectors::Reader::open(file.data(), file.size());
+    REQUIRE( reader.has_value() );
 
-    for (auto& test : tests) {
-        CPUState initialCPUState;
-        initialCPUState.accumulator     = test["initial"]["a"];
-        initialCPUState.pc              = test["initial"]["pc"];
-        initialCPUState.sp              = test["initial"]["s"];
-        initialCPUState.indexX          = test["initial"]["x"];
-        initialCPUState.indexY          = test["initial"]["y"];
-        initialCPUState.processorStatus = test["initial"]["p"];
-
-        NES nes(initialCPUState);
-
-        // Set memory to initial values
-        // ramItem[0] is the address and ramItem[1] is the value
-        for (auto& ramItem : test["initial"]["ram"]) {
-            nes.memoryWrite(ramItem[address], ramItem[value]);
-        }
-
-        // Run CPU for the given instruction
-        nes.tickCPU();
-
-        // Get the final state of the CPU
-        CPUState endCPUState = nes.getCPUState();
-
-        // Get the expected state of the CPU
-        CPUState expectedCPUState;
-        expectedCPUState.accumulator     = test["final"]["a"];
-        expectedCPUState.pc              = test["final"]["pc"];
-        expectedCPUState.sp              = test["final"]["s"];
-        expectedCPUState.indexX          = test["final"]["x"];
-        expectedCPUState.indexY          = test["final"]["y"];
-        expectedCPUState.processorStatus = test["final"]["p"];
-
-        bool ramMatch = true;
-
-        std::ostringstream expectedMem;
-        std::ostringstream actualMem;
-
-        // Check if memory contents equal expected values
-        for (auto& ramItem : test["final"]["ram"]) {
-            expectedMem << "\tAddr: " << ramItem[address] << " Val: " << ramItem[value] << "\n";
-            actualMem << "\tAddr: " << ramItem[address] << " Val: " << +nes.memoryRead(ramItem[address]) << "\n";
-            if (ramItem[value] != nes.memoryRead(ramItem[address])) {
-                ramMatch = false;
+    auto runner = std::make_unique<OpcodeTestRunner>();
+    uint32_t testsRun = 0;
+
+    while (std::optional<TestVectors::TestCase> test = reader->next()) {
+        std::optional<std::string> failure = runner->run(*test);
+
+        if (failure.has_value()) {
+            FAIL( *failure );
+        }
+
+        testsRun++;
+    }
+
+    REQUIRE( testsRun == reader->getCaseCount() );
+}
+
+// Runs every packed test file in ./tests, split into shards of a few thousand tests spread across every core.
+// Hidden from the default run, select it with: cputest [parallel]
+TEST_CASE("All opcodes, sharded across threads", "[.][parallel]")
+{
+    constexpr uint32_t testsPerShard = 2000;
+    constexpr std::size_t maxReportedFailures = 20;
+
+    struct Shard
+    {
+        std::size_t fileIndex;
+        const uint8_t *start;
+        const uint8_t *end;
+        uint32_t testCount;
+    };
+
+    std::vector<std::filesystem::path> paths;
+    for (const auto &entry : std::filesystem::directory_iterator("./tests")) {
+        if (entry.path().extension() == ".bin") {
+            paths.push_back(entry.path());
+        }
+    }
+
+    // Sorted so shards, and so the failures they find, always come out in the same order
+    std::sort(paths.begin(), paths.end());
+    REQUIRE( !paths.empty() );
+
+    std::vector<MappedFile> files;
+    std::vector<Shard> shards;
+
+    for (std::size_t fileIndex = 0; fileIndex < paths.size(); fileIndex++) {
+        const MappedFile &file = files.emplace_back(paths[fileIndex].string());
+
+        std::optional<TestVectors::Reader> reader = TestVectors::Reader::open(file.data(), file.size());
+        REQUIRE( reader.has_value() );
+
+        // Walk the records once to find where each shard starts
+        const uint8_t *shardStart = reader->getPosition();
+        uint32_t testCount = 0;
+
+        while (reader->next().has_value()) {
+            testCount++;
+
+            if (testCount % testsPerShard == 0 || testCount == reader->getCaseCount()) {
+                const uint32_t shardTests = testCount % testsPerShard == 0 ? testsPerShard : testCount % testsPerShard;
+                shards.push_back({ fileIndex, shardStart, reader->getPosition(), shardTests });
+                shardStart = reader->getPosition();
+            }
+        }
+
+        REQUIRE( testCount == reader->getCaseCount() );
+    }
+
+    WorkStealingPool pool(static_cast<int>(std::thread::hardware_concurrency()));
+
+    std::vector<std::unique_ptr<OpcodeTestRunner>> runners;
+    for (int i = 0; i < pool.getThreadCount(); i++) {
+        runners.push_back(std::make_unique<OpcodeTestRunner>());
+    }
+
+    // Each shard only ever writes to its own list, so no locking is needed
+    std::vector<std::vector<std::string>> shardFailures(shards.size());
+
+    pool.run(shards.size(), [&](std::size_t shardIndex, int worker) {
+        const Shard &shard = shards[shardIndex];
+        TestVectors::Reader reader(shard.start, shard.end, shard.testCount);
+
+        while (std::optional<TestVectors::TestCase> test = reader.next()) {
+            std::optional<std::string> failure = runners[worker]->run(*test);
+
+            if (failure.has_value()) {
+                shardFailures[shardIndex].push_back(paths[shard.fileIndex].filename().string() + ": " + *failure);
+            }
+        }
+    });
+
+    std::size_t failureCount = 0;
+
+    for (const std::vector<std::string> &failures : shardFailures) {
+        for (const std::string &failure : failures) {
+            if (failureCount++ < maxReportedFailures) {
+                FAIL_CHECK( failure );
+            }
+        }
+    }
+
+    INFO(std::to_string(failureCount) + " failing tests across " + std::to_string(paths.size()) + " files");
+    REQUIRE( failureCount == 0 );
+}
+
+// Runs a program which rewrites its own immediate operand every iteration on the plain interpreter,
+// the cached interpreter and the JIT, which should all stay in lockstep
+TEST_CASE("Block cache with self-modifying code", "[BlockCache]")
+{
+    const std::vector<uint8_t> program {
+        0xA9, 0x01,        // LDA #$01
+        0x18,              // CLC
+        0x69, 0x01,        // ADC #$01
+        0x8D, 0x01, 0x02,  // STA $0201
+        0x4C, 0x00, 0x02,  // JMP $0200
+    };
+
+    CPUState initialCPUState;
+    initialCPUState.pc = 0x0200;
+    initialCPUState.sp = 0xFD;
+    initialCPUState.processorStatus = 0x24;
+
+    FlatBus interpreterBus;
+    FlatBus blockCacheBus;
+    FlatBus jitBus;
+
+    for (size_t i = 0; i < program.size(); i++) {
+        interpreterBus.memoryWrite(0x0200 + i, program[i]);
+        blockCacheBus.memoryWrite(0x0200 + i, program[i]);
+        jitBus.memoryWrite(0x0200 + i, program[i]);
+    }
+
+    CPU<FlatBus> interpreter(initialCPUState);
+    interpreter.connectToBus(&interpreterBus);
+
+    CPU<FlatBus> blockCache(initialCPUState);
+    blockCache.connectToBus(&blockCacheBus);
+    blockCache.setBlockCacheEnabled(true);
+
+    CPU<FlatBus> jit(initialCPUState);
+    jit.connectToBus(&jitBus);
+    jit.setJITEnabled(true);
+
+    for (uint64_t targetCycle = 100; targetCycle <= 10'000; targetCycle += 100) {
+        interpreter.runUntilWithFunctionTable(targetCycle);
+        blockCache.runUntil(targetCycle);
+        jit.runUntil(targetCycle);
+
+        CPUState interpreterState = interpreter.getState();
+        CPUState blockCacheState = blockCache.getState();
+        CPUState jitState = jit.getState();
+
+        INFO("Target cycle: " + std::to_string(targetCycle));
+        INFO("Interpreter CPU State:\n\t" + interpreterState.toString() + "\nBlock Cache CPU State:\n\t" + blockCacheState.toString());
+
+        REQUIRE( (interpreterState == blockCacheState) );
+        REQUIRE( interpreter.getCycleCount() == blockCache.getCycleCount() );
+        REQUIRE( interpreterBus.memoryRead(0x0201) == blockCacheBus.memoryRead(0x0201) );
+
+        INFO("JIT CPU State:\n\t" + jitState.toString());
+
+        REQUIRE( (interpreterState == jitState) );
+        REQUIRE( interpreter.getCycleCount() == jit.getCycleCount() );
+        REQUIRE( interpreterBus.memoryRead(0x0201) == jitBus.memoryRead(0x0201) );
+    }
+}
+
+// The inner loop runs often enough to be compiled, and the block it ends up in rewrites the operand of
+// one of its own later instructions. Compiled code has to notice and leave, or Y would get a stale value.
+TEST_CASE("JIT with self-modifying code", "[JIT]")
+{
+    const std::vector<uint8_t> program {
+        0xA2, 0x00,        // LDX #$00
+        0xE8,              // INX
+        0xD0, 0xFD,        // BNE $0202
+        0xEE, 0x09, 0x02,  // INC $0209
+        0xA0, 0x00,        // LDY #$00
+        0x4C, 0x00, 0x02,  // JMP $0200
+    };
+
+    CPUState initialCPUState;
+    initialCPUState.pc = 0x0200;
+    initialCPUState.sp = 0xFD;
+    initialCPUState.processorStatus = 0x24;
+
+    FlatBus interpreterBus;
+    FlatBus jitBus;
+
+    for (size_t i = 0; i < program.size(); i++) {
+        interpreterBus.memoryWrite(0x0200 + i, program[i]);
+        jitBus.memoryWrite(0x0200 + i, program[i]);
+    }
+
+    CPU<FlatBus> interpreter(initialCPUState);
+    interpreter.connectToBus(&interpreterBus);
+
+    CPU<FlatBus> jit(initialCPUState);
+    jit.connectToBus(&jitBus);
+    jit.setJITEnabled(true);
+
+    for (uint64_t targetCycle = 1'000; targetCycle <= 200'000; targetCycle += 1'000) {
+        interpreter.runUntilWithFunctionTable(targetCycle);
+        jit.runUntil(targetCycle);
+
+        CPUState interpreterState = interpreter.getState();
+        CPUState jitState = jit.getState();
+
+        INFO("Target cycle: " + std::to_string(targetCycle));
+        INFO("Interpreter CPU State:\n\t" + interpreterState.toString() + "\nJIT CPU State:\n\t" + jitState.toString());
+
+        REQUIRE( (interpreterState == jitState) );
+        REQUIRE( interpreter.getCycleCount() == jit.getCycleCount() );
+        REQUIRE( interpreter.getInstructionCount() == jit.getInstructionCount() );
+        REQUIRE( interpreterBus.memoryRead(0x0209) == jitBus.memoryRead(0x0209) );
+    }
+}
+
+// Same as above, but the operand is rewritten through a mirror of the page the code runs from, which has to
+// invalidate the compiled code just the same
+TEST_CASE("JIT with code modified through a RAM mirror", "[JIT]")
+{
+    const std::vector<uint8_t> program {
+        0xA2, 0x00,        // LDX #$00
+        0xE8,              // INX
+        0xD0, 0xFD,        // BNE $0202
+        0xEE, 0x09, 0x0A,  // INC $0A09 (mirror of $0209)
+        0xA0, 0x00,        // LDY #$00
+        0x4C, 0x00, 0x02,  // JMP $0200
+    };
+
+    CPUState initialCPUState;
+    initialCPUState.pc = 0x0200;
+    initialCPUState.sp = 0xFD;
+    initialCPUState.processorStatus = 0x24;
+
+    MirroredRAMBus interpreterBus;
+    MirroredRAMBus jitBus;
+
+    for (size_t i = 0; i < program.size(); i++) {
+        interpreterBus.memoryWrite(0x0200 + i, program[i]);
+        jitBus.memoryWrite(0x0200 + i, program[i]);
+    }
+
+    CPU<MirroredRAMBus> interpreter(initialCPUState);
+    interpreter.connectToBus(&interpreterBus);
+
+    CPU<MirroredRAMBus> jit(initialCPUState);
+    jit.connectToBus(&jitBus);
+    jit.setJITEnabled(true);
+
+    for (uint64_t targetCycle = 1'000; targetCycle <= 200'000; targetCycle += 1'000) {
+        interpreter.runUntilWithFunctionTable(targetCycle);
+        jit.runUntil(targetCycle);
+
+        CPUState interpreterState = interpreter.getState();
+        CPUState jitState = jit.getState();
+
+        INFO("Target cycle: " + std::to_string(targetCycle));
+        INFO("Interpreter CPU State:\n\t" + interpreterState.toString() + "\nJIT CPU State:\n\t" + jitState.toString());
+
+        REQUIRE( (interpreterState == jitState) );
+        REQUIRE( interpreter.getCycleCount() == jit.getCycleCount() );
+        REQUIRE( jitBus.memoryRead(0x1A09) == interpreterBus.memoryRead(0x0209) );
+    }
+}
+
+// Blocks only add up their cycles when they exit, but accesses from the middle of one still have to see the cycle
+// the instruction started on, whether it's generated inline, calls a handler or is interpreted
+TEST_CASE("Cycle of accesses from inside blocks", "[BlockCache][JIT]")
+{
+    const std::vector<uint8_t> program {
+        0xA2, 0x00,        // LDX #$00
+        0xEA,              // NOP
+        0xAD, 0x02, 0x20,  // LDA $2002
+        0x2C, 0x02, 0x20,  // BIT $2002
+        0x8D, 0x05, 0x20,  // STA $2005
+        0xE8,              // INX
+        0xD0, 0xF3,        // BNE $0202
+        0x4C, 0x00, 0x02,  // JMP $0200
+    };
+
+    CPUState initialCPUState;
+    initialCPUState.pc = 0x0200;
+    initialCPUState.sp = 0xFD;
+    initialCPUState.processorStatus = 0x24;
+
+    std::array<TimestampBus, 3> buses;
+    std::vector<std::unique_ptr<CPU<TimestampBus>>> cpus;
+
+    for (TimestampBus &bus : buses) {
+        for (size_t i = 0; i < program.size(); i++) {
+            bus.memoryWrite(0x0200 + i, program[i]);
+        }
+
+        cpus.push_back(std::make_unique<CPU<TimestampBus>>(initialCPUState));
+        cpus.back()->connectToBus(&bus);
+        bus.cpu = cpus.back().get();
+    }
+
+    cpus[1]->setBlockCacheEnabled(true);
+    cpus[2]->setJITEnabled(true);
+
+    cpus[0]->runUntilWithFunctionTable(50'000);
+    cpus[1]->runUntil(50'000);
+    cpus[2]->runUntil(50'000);
+
+    REQUIRE( buses[0].accesses.size() > 3 * 256 );
+    REQUIRE( buses[0].accesses[0] == TimestampBus::Access { 0x2002, 4 } );
+    REQUIRE( (buses[1].accesses == buses[0].accesses) );
+    REQUIRE( (buses[2].accesses == buses[0].accesses) );
+}
+
+// IRQ has to wait for CLI, while NMI is taken straight away even from inside the IRQ handler
+TEST_CASE("Interrupt lines", "[Interrupts]")
+{
+    enum class Backend { interpreter, blockCache, jit };
+
+    for (Backend backend : { Backend::interpreter, Backend::blockCache, Backend::jit }) {
+        FlatBus bus;
+
+        const std::vector<std::pair<uint16_t, std::vector<uint8_t>>> code {
+            { 0x0200, { 0x58, 0xE8, 0x4C, 0x01, 0x02 } },  // CLI, INX, JMP $0201
+            { 0x0300, { 0xA9, 0x42, 0x4C, 0x02, 0x03 } },  // LDA #$42, JMP $0302
+            { 0x0400, { 0xA9, 0x99, 0x4C, 0x02, 0x04 } },  // LDA #$99, JMP $0402
+            { 0xFFFA, { 0x00, 0x04 } },                    // NMI vector
+            { 0xFFFE, { 0x00, 0x03 } },                    // IRQ vector
+        };
+
+        for (const auto &[start, bytes] : code) {
+            for (size_t i = 0; i < bytes.size(); i++) {
+                bus.memoryWrite(start + i, bytes[i]);
             }
         }
 
-        // Info statements will only be displayed if an assertion fails
-        INFO("Operation: " + test["name"].dump());
-        INFO("Expected CPU State:\n\t" + expectedCPUState.toString() + "\nActual CPU State:\n\t" + endCPUState.toString());
-        INFO("Expected Memory State:\n" + expectedMem.str() + "Actual Memory State:\n" + actualMem.str());
+        CPUState initialCPUState;
+        initialCPUState.pc = 0x0200;
+        initialCPUState.sp = 0xFD;
+        initialCPUState.processorStatus = 0x24;
+
+        CPU<FlatBus> cpu(initialCPUState);
+        cpu.connectToBus(&bus);
+
+        if (backend == Backend::blockCache) {
+            cpu.setBlockCacheEnabled(true);
+        } else if (backend == Backend::jit) {
+            cpu.setJITEnabled(true);
+        }
 
-        REQUIRE( (expectedCPUState == endCPUState) );
-        REQUIRE( ramMatch );
+        INFO("Backend: " + std::to_string(static_cast<int>(backend)));
+
+        cpu.setIRQLine(true);
+        cpu.runUntil(5'000);
+
+        CPUState irqState = cpu.getState();
+
+        REQUIRE( irqState.accumulator == 0x42 );
+        REQUIRE( irqState.sp == 0xFA );
+        REQUIRE( (irqState.processorStatus & getFlagMask(Flags::interruptDisable)) != 0 );
+        REQUIRE( (bus.memoryRead(0x01FB) & getFlagMask(Flags::breakCommand)) == 0 );
+        REQUIRE( (bus.memoryRead(0x01FB) & getFlagMask(Flags::interruptDisable)) == 0 );
+
+        cpu.triggerNMI();
+        cpu.runUntil(10'000);
+
+        CPUState nmiState = cpu.getState();
+
+        REQUIRE( nmiState.accumulator == 0x99 );
+        REQUIRE( nmiState.sp == 0xF7 );
+        REQUIRE( bus.memoryRead(0x01FA) == 0x03 );  // Interrupted the IRQ handler's loop at $0302
+        REQUIRE( bus.memoryRead(0x01F9) == 0x02 );
     }
 }
 
-TEST_CASE("Opcode $00", "[BRK]") { testOpcode("00.json"); }
-TEST_CASE("Opcode $01", "[ORA]") { testOpcode("01.json"); }
-TEST_CASE("Opcode $05", "[ORA]") { testOpcode("05.json"); }
-TEST_CASE("Opcode $06", "[ASL]") { testOpcode("06.json"); }
-TEST_CASE("Opcode $08", "[PHP]") { testOpcode("08.json"); }
-TEST_CASE("Opcode $09", "[ORA]") { testOpcode("09.json"); }
-TEST_CASE("Opcode $0a", "[ASL]") { testOpcode("0a.json"); }
-TEST_CASE("Opcode $0d", "[ORA]") { testOpcode("0d.json"); }
-TEST_CASE("Opcode $0e", "[ASL]") { testOpcode("0e.json"); }
-
-TEST_CASE("Opcode $10", "[BPL]") { testOpcode("10.json"); }
-TEST_CASE("Opcode $11", "[ORA]") { testOpcode("11.json"); }
-TEST_CASE("Opcode $15", "[ORA]") { testOpcode("15.json"); }
-TEST_CASE("Opcode $16", "[ASL]") { testOpcode("16.json"); }
-TEST_CASE("Opcode $18", "[CLC]") { testOpcode("18.json"); }
-TEST_CASE("Opcode $19", "[ORA]") { testOpcode("19.json"); }
-TEST_CASE("Opcode $1d", "[ORA]") { testOpcode("1d.json"); }
-TEST_CASE("Opcode $1e", "[ASL]") { testOpcode("1e.json"); }
-
-TEST_CASE("Opcode $20", "[JSR]") { testOpcode("20.json"); }
-TEST_CASE("Opcode $21", "[AND]") { testOpcode("21.json"); }
-TEST_CASE("Opcode $24", "[BIT]") { testOpcode("24.json"); }
-TEST_CASE("Opcode $25", "[AND]") { testOpcode("25.json"); }
-TEST_CASE("Opcode $26", "[ROL]") { testOpcode("26.json"); }
-TEST_CASE("Opcode $28", "[PLP]") { testOpcode("28.json"); }
-TEST_CASE("Opcode $29", "[AND]") { testOpcode("29.json"); }
-TEST_CASE("Opcode $2a", "[ROL]") { testOpcode("2a.json"); }
-TEST_CASE("Opcode $2c", "[BIT]") { testOpcode("2c.json"); }
-TEST_CASE("Opcode $2d", "[AND]") { testOpcode("2d.json"); }
-TEST_CASE("Opcode $2e", "[ROL]") { testOpcode("2e.json"); }
-
-TEST_CASE("Opcode $30", "[BMI]") { testOpcode("30.json"); }
-TEST_CASE("Opcode $31", "[AND]") { testOpcode("31.json"); }
-TEST_CASE("Opcode $35", "[AND]") { testOpcode("35.json"); }
-TEST_CASE("Opcode $36", "[ROL]") { testOpcode("36.json"); }
-TEST_CASE("Opcode $38", "[SEC]") { testOpcode("38.json"); }
-TEST_CASE("Opcode $39", "[AND]") { testOpcode("39.json"); }
-TEST_CASE("Opcode $3d", "[AND]") { testOpcode("3d.json"); }
-TEST_CASE("Opcode $3e", "[ROL]") { testOpcode("3e.json"); }
-
-TEST_CASE("Opcode $40", "[RTI]") { testOpcode("40.json"); }
-TEST_CASE("Opcode $41", "[EOR]") { testOpcode("41.json"); }
-TEST_CASE("Opcode $45", "[EOR]") { testOpcode("45.json"); }
-TEST_CASE("Opcode $46", "[LSR]") { testOpcode("46.json"); }
-TEST_CASE("Opcode $48", "[PHA]") { testOpcode("48.json"); }
-TEST_CASE("Opcode $49", "[EOR]") { testOpcode("49.json"); }
-TEST_CASE("Opcode $4a", "[LSR]") { testOpcode("4a.json"); }
-TEST_CASE("Opcode $4c", "[JMP]") { testOpcode("4c.json"); }
-TEST_CASE("Opcode $4d", "[EOR]") { testOpcode("4d.json"); }
-TEST_CASE("Opcode $4e", "[LSR]") { testOpcode("4e.json"); }
-
-TEST_CASE("Opcode $50", "[BVC]") { testOpcode("50.json"); }
-TEST_CASE("Opcode $51", "[EOR]") { testOpcode("51.json"); }
-TEST_CASE("Opcode $55", "[EOR]") { testOpcode("55.json"); }
-TEST_CASE("Opcode $56", "[LSR]") { testOpcode("56.json"); }
-TEST_CASE("Opcode $58", "[CLI]") { testOpcode("58.json"); }
-TEST_CASE("Opcode $59", "[EOR]") { testOpcode("59.json"); }
-TEST_CASE("Opcode $5d", "[EOR]") { testOpcode("5d.json"); }
-TEST_CASE("Opcode $5e", "[LSR]") { testOpcode("5e.json"); }
-
-TEST_CASE("Opcode $60", "[RTS]") { testOpcode("60.json"); }
-TEST_CASE("Opcode $61", "[ADC]") { testOpcode("61.json"); }
-TEST_CASE("Opcode $65", "[ADC]") { testOpcode("65.json"); }
-TEST_CASE("Opcode $66", "[ROR]") { testOpcode("66.json"); }
-TEST_CASE("Opcode $68", "[PLA]") { testOpcode("68.json"); }
-TEST_CASE("Opcode $69", "[ADC]") { testOpcode("69.json"); }
-TEST_CASE("Opcode $6a", "[ROR]") { testOpcode("6a.json"); }
-TEST_CASE("Opcode $6c", "[JMP]") { testOpcode("6c.json"); }
-TEST_CASE("Opcode $6d", "[ADC]") { testOpcode("6d.json"); }
-TEST_CASE("Opcode $6e", "[ROR]") { testOpcode("6e.json"); }
-
-TEST_CASE("Opcode $70", "[BVS]") { testOpcode("70.json"); }
-TEST_CASE("Opcode $71", "[ADC]") { testOpcode("71.json"); }
-TEST_CASE("Opcode $75", "[ADC]") { testOpcode("75.json"); }
-TEST_CASE("Opcode $76", "[ROR]") { testOpcode("76.json"); }
-TEST_CASE("Opcode $78", "[SEI]") { testOpcode("78.json"); }
-TEST_CASE("Opcode $79", "[ADC]") { testOpcode("79.json"); }
-TEST_CASE("Opcode $7d", "[ADC]") { testOpcode("7d.json"); }
-TEST_CASE("Opcode $7e", "[ROR]") { testOpcode("7e.json"); }
-
-TEST_CASE("Opcode $81", "[STA]") { testOpcode("81.json"); }
-TEST_CASE("Opcode $84", "[STY]") { testOpcode("84.json"); }
-TEST_CASE("Opcode $85", "[STA]") { testOpcode("85.json"); }
-TEST_CASE("Opcode $86", "[STX]") { testOpcode("86.json"); }
-TEST_CASE("Opcode $88", "[DEY]") { testOpcode("88.json"); }
-TEST_CASE("Opcode $8a", "[TXA]") { testOpcode("8a.json"); }
-TEST_CASE("Opcode $8c", "[STY]") { testOpcode("8c.json"); }
-TEST_CASE("Opcode $8d", "[STA]") { testOpcode("8d.json"); }
-TEST_CASE("Opcode $8e", "[STX]") { testOpcode("8e.json"); }
-
-TEST_CASE("Opcode $90", "[BCC]") { testOpcode("90.json"); }
-TEST_CASE("Opcode $91", "[STA]") { testOpcode("91.json"); }
-TEST_CASE("Opcode $94", "[STY]") { testOpcode("94.json"); }
-TEST_CASE("Opcode $95", "[STA]") { testOpcode("95.json"); }
-TEST_CASE("Opcode $96", "[STX]") { testOpcode("96.json"); }
-TEST_CASE("Opcode $98", "[TYA]") { testOpcode("98.json"); }
-TEST_CASE("Opcode $99", "[STA]") { testOpcode("99.json"); }
-TEST_CASE("Opcode $9a", "[TXS]") { testOpcode("9a.json"); }
-TEST_CASE("Opcode $9d", "[STA]") { testOpcode("9d.json"); }
-
-TEST_CASE("Opcode $a0", "[LDY]") { testOpcode("a0.json"); }
-TEST_CASE("Opcode $a1", "[LDA]") { testOpcode("a1.json"); }
-TEST_CASE("Opcode $a2", "[LDX]") { testOpcode("a2.json"); }
-TEST_CASE("Opcode $a4", "[LDY]") { testOpcode("a4.json"); }
-TEST_CASE("Opcode $a5", "[LDA]") { testOpcode("a5.json"); }
-TEST_CASE("Opcode $a6", "[LDX]") { testOpcode("a6.json"); }
-TEST_CASE("Opcode $a8", "[TAY]") { testOpcode("a8.json"); }
-TEST_CASE("Opcode $a9", "[LDA]") { testOpcode("a9.json"); }
-TEST_CASE("Opcode $aa", "[TAX]") { testOpcode("aa.json"); }
-TEST_CASE("Opcode $ac", "[LDY]") { testOpcode("ac.json"); }
-TEST_CASE("Opcode $ad", "[LDA]") { testOpcode("ad.json"); }
-TEST_CASE("Opcode $ae", "[LDX]") { testOpcode("ae.json"); }
-
-TEST_CASE("Opcode $b0", "[BCS]") { testOpcode("b0.json"); }
-TEST_CASE("Opcode $b1", "[LDA]") { testOpcode("b1.json"); }
-TEST_CASE("Opcode $b4", "[LDY]") { testOpcode("b4.json"); }
-TEST_CASE("Opcode $b5", "[LDA]") { testOpcode("b5.json"); }
-TEST_CASE("Opcode $b6", "[LDX]") { testOpcode("b6.json"); }
-TEST_CASE("Opcode $b8", "[CLV]") { testOpcode("b8.json"); }
-TEST_CASE("Opcode $b9", "[LDA]") { testOpcode("b9.json"); }
-TEST_CASE("Opcode $ba", "[TSX]") { testOpcode("ba.json"); }
-TEST_CASE("Opcode $bc", "[LDY]") { testOpcode("bc.json"); }
-TEST_CASE("Opcode $bd", "[LDA]") { testOpcode("bd.json"); }
-TEST_CASE("Opcode $be", "[LDX]") { testOpcode("be.json"); }
-
-TEST_CASE("Opcode $c0", "[CPY]") { testOpcode("c0.json"); }
-TEST_CASE("Opcode $c1", "[CMP]") { testOpcode("c1.json"); }
-TEST_CASE("Opcode $c4", "[CPY]") { testOpcode("c4.json"); }
-TEST_CASE("Opcode $c5", "[CMP]") { testOpcode("c5.json"); }
-TEST_CASE("Opcode $c6", "[DEC]") { testOpcode("c6.json"); }
-TEST_CASE("Opcode $c8", "[INY]") { testOpcode("c8.json"); }
-TEST_CASE("Opcode $c9", "[CMP]") { testOpcode("c9.json"); }
-TEST_CASE("Opcode $ca", "[DEX]") { testOpcode("ca.json"); }
-TEST_CASE("Opcode $cc", "[CPY]") { testOpcode("cc.json"); }
-TEST_CASE("Opcode $cd", "[CMP]") { testOpcode("cd.json"); }
-TEST_CASE("Opcode $ce", "[DEC]") { testOpcode("ce.json"); }
-
-TEST_CASE("Opcode $d0", "[BNE]") { testOpcode("d0.json"); }
-TEST_CASE("Opcode $d1", "[CMP]") { testOpcode("d1.json"); }
-TEST_CASE("Opcode $d5", "[CMP]") { testOpcode("d5.json"); }
-TEST_CASE("Opcode $d6", "[DEC]") { testOpcode("d6.json"); }
-TEST_CASE("Opcode $d8", "[CLD]") { testOpcode("d8.json"); }
-TEST_CASE("Opcode $d9", "[CMP]") { testOpcode("d9.json"); }
-TEST_CASE("Opcode $dd", "[CMP]") { testOpcode("dd.json"); }
-TEST_CASE("Opcode $de", "[DEC]") { testOpcode("de.json"); }
-
-TEST_CASE("Opcode $e0", "[CPX]") { testOpcode("e0.json"); }
-TEST_CASE("Opcode $e1", "[SBC]") { testOpcode("e1.json"); }
-TEST_CASE("Opcode $e4", "[CPX]") { testOpcode("e4.json"); }
-TEST_CASE("Opcode $e5", "[SBC]") { testOpcode("e5.json"); }
-TEST_CASE("Opcode $e6", "[INC]") { testOpcode("e6.json"); }
-TEST_CASE("Opcode $e8", "[INX]") { testOpcode("e8.json"); }
-TEST_CASE("Opcode $e9", "[SBC]") { testOpcode("e9.json"); }
-TEST_CASE("Opcode $ea", "[NOP]") { testOpcode("ea.json"); }
-TEST_CASE("Opcode $ec", "[CPX]") { testOpcode("ec.json"); }
-TEST_CASE("Opcode $ed", "[SBC]") { testOpcode("ed.json"); }
-TEST_CASE("Opcode $ee", "[INC]") { testOpcode("ee.json"); }
-
-TEST_CASE("Opcode $f0", "[BEQ]") { testOpcode("f0.json"); }
-TEST_CASE("Opcode $f1", "[SBC]") { testOpcode("f1.json"); }
-TEST_CASE("Opcode $f5", "[SBC]") { testOpcode("f5.json"); }
-TEST_CASE("Opcode $f6", "[INC]") { testOpcode("f6.json"); }
-TEST_CASE("Opcode $f8", "[SED]") { testOpcode("f8.json"); }
-TEST_CASE("Opcode $f9", "[SBC]") { testOpcode("f9.json"); }
-TEST_CASE("Opcode $fd", "[SBC]") { testOpcode("fd.json"); }
-TEST_CASE("Opcode $fe", "[INC]") { testOpcode("fe.json"); }
\ No newline at end of file
+// Stores from JIT compiled code skip memoryWrite() once a page is mapped, so the bus has to catch the first
+// one to know the page needs clearing. The program is reloaded behind the CPU's back, so the CPU reset has to
+// drop the code it compiled from the first version too.
+TEST_CASE("Bus and CPU reset", "[Reset]")
+{
+    FlatBus bus;
+
+    const auto loadProgram = [&bus](uint8_t value) {
+        const std::vector<uint8_t> program {
+            0xA9, value,        // LDA #value
+            0x9D, 0x00, 0x03,   // STA $0300,X
+            0x9D, 0x00, 0x05,   // STA $0500,X
+            0xE8,               // INX
+            0xD0, 0xF7,         // BNE $0202
+            0x4C, 0x0B, 0x02,   // JMP $020B
+        };
+
+        for (size_t i = 0; i < program.size(); i++) {
+            bus.memoryWrite(0x0200 + i, program[i]);
+        }
+
+        bus.memoryWrite(0xFFFC, 0x00);
+        bus.memoryWrite(0xFFFD, 0x02);
+    };
+
+    CPU<FlatBus> cpu;
+    cpu.connectToBus(&bus);
+    cpu.setJITEnabled(true);
+
+    loadProgram(0x5A);
+    cpu.reset();
+    cpu.runUntil(20'000);
+
+    REQUIRE( bus.memoryRead(0x0300) == 0x5A );
+    REQUIRE( bus.memoryRead(0x05FF) == 0x5A );
+
+    bus.reset();
+
+    int nonZeroBytes = 0;
+    for (uint32_t address = 0; address < 0x10000; address++) {
+        nonZeroBytes += bus.memoryRead(static_cast<uint16_t>(address)) != 0;
+    }
+    REQUIRE( nonZeroBytes == 0 );
+
+    loadProgram(0xA5);
+    cpu.reset();
+    cpu.runUntil(20'000);
+
+    REQUIRE( cpu.getCycleCount() < 20'010 );
+    REQUIRE( bus.memoryRead(0x0300) == 0xA5 );
+    REQUIRE( bus.memoryRead(0x05FF) == 0xA5 );
+}
+
+TEST_CASE("Opcode $00", "[BRK]") { testOpcode("00.bin"); }
+TEST_CASE("Opcode $01", "[ORA]") { testOpcode("01.bin"); }
+TEST_CASE("Opcode $05", "[ORA]") { testOpcode("05.bin"); }
+TEST_CASE("Opcode $06", "[ASL]") { testOpcode("06.bin"); }
+TEST_CASE("Opcode $08", "[PHP]") { testOpcode("08.bin"); }
+TEST_CASE("Opcode $09", "[ORA]") { testOpcode("09.bin"); }
+TEST_CASE("Opcode $0a", "[ASL]") { testOpcode("0a.bin"); }
+TEST_CASE("Opcode $0d", "[ORA]") { testOpcode("0d.bin"); }
+TEST_CASE("Opcode $0e", "[ASL]") { testOpcode("0e.bin"); }
+
+TEST_CASE("Opcode $10", "[BPL]") { testOpcode("10.bin"); }
+TEST_CASE("Opcode $11", "[ORA]") { testOpcode("11.bin"); }
+TEST_CASE("Opcode $15", "[ORA]") { testOpcode("15.bin"); }
+TEST_CASE("Opcode $16", "[ASL]") { testOpcode("16.bin"); }
+TEST_CASE("Opcode $18", "[CLC]") { testOpcode("18.bin"); }
+TEST_CASE("Opcode $19", "[ORA]") { testOpcode("19.bin"); }
+TEST_CASE("Opcode $1d", "[ORA]") { testOpcode("1d.bin"); }
+TEST_CASE("Opcode $1e", "[ASL]") { testOpcode("1e.bin"); }
+
+TEST_CASE("Opcode $20", "[JSR]") { testOpcode("20.bin"); }
+TEST_CASE("Opcode $21", "[AND]") { testOpcode("21.bin"); }
+TEST_CASE("Opcode $24", "[BIT]") { testOpcode("24.bin"); }
+TEST_CASE("Opcode $25", "[AND]") { testOpcode("25.bin"); }
+TEST_CASE("Opcode $26", "[ROL]") { testOpcode("26.bin"); }
+TEST_CASE("Opcode $28", "[PLP]") { testOpcode("28.bin"); }
+TEST_CASE("Opcode $29", "[AND]") { testOpcode("29.bin"); }
+TEST_CASE("Opcode $2a", "[ROL]") { testOpcode("2a.bin"); }
+TEST_CASE("Opcode $2c", "[BIT]") { testOpcode("2c.bin"); }
+TEST_CASE("Opcode $2d", "[AND]") { testOpcode("2d.bin"); }
+TEST_CASE("Opcode $2e", "[ROL]") { testOpcode("2e.bin"); }
+
+TEST_CASE("Opcode $30", "[BMI]") { testOpcode("30.bin"); }
+TEST_CASE("Opcode $31", "[AND]") { testOpcode("31.bin"); }
+TEST_CASE("Opcode $35", "[AND]") { testOpcode("35.bin"); }
+TEST_CASE("Opcode $36", "[ROL]") { testOpcode("36.bin"); }
+TEST_CASE("Opcode $38", "[SEC]") { testOpcode("38.bin"); }
+TEST_CASE("Opcode $39", "[AND]") { testOpcode("39.bin"); }
+TEST_CASE("Opcode $3d", "[AND]") { testOpcode("3d.bin"); }
+TEST_CASE("Opcode $3e", "[ROL]") { testOpcode("3e.bin"); }
+
+TEST_CASE("Opcode $40", "[RTI]") { testOpcode("40.bin"); }
+TEST_CASE("Opcode $41", "[EOR]") { testOpcode("41.bin"); }
+TEST_CASE("Opcode $45", "[EOR]") { testOpcode("45.bin"); }
+TEST_CASE("Opcode $46", "[LSR]") { testOpcode("46.bin"); }
+TEST_CASE("Opcode $48", "[PHA]") { testOpcode("48.bin"); }
+TEST_CASE("Opcode $49", "[EOR]") { testOpcode("49.bin"); }
+TEST_CASE("Opcode $4a", "[LSR]") { testOpcode("4a.bin"); }
+TEST_CASE("Opcode $4c", "[JMP]") { testOpcode("4c.bin"); }
+TEST_CASE("Opcode $4d", "[EOR]") { testOpcode("4d.bin"); }
+TEST_CASE("Opcode $4e", "[LSR]") { testOpcode("4e.bin"); }
+
+TEST_CASE("Opcode $50", "[BVC]") { testOpcode("50.bin"); }
+TEST_CASE("Opcode $51", "[EOR]") { testOpcode("51.bin"); }
+TEST_CASE("Opcode $55", "[EOR]") { testOpcode("55.bin"); }
+TEST_CASE("Opcode $56", "[LSR]") { testOpcode("56.bin"); }
+TEST_CASE("Opcode $58", "[CLI]") { testOpcode("58.bin"); }
+TEST_CASE("Opcode $59", "[EOR]") { testOpcode("59.bin"); }
+TEST_CASE("Opcode $5d", "[EOR]") { testOpcode("5d.bin"); }
+TEST_CASE("Opcode $5e", "[LSR]") { testOpcode("5e.bin"); }
+
+TEST_CASE("Opcode $60", "[RTS]") { testOpcode("60.bin"); }
+TEST_CASE("Opcode $61", "[ADC]") { testOpcode("61.bin"); }
+TEST_CASE("Opcode $65", "[ADC]") { testOpcode("65.bin"); }
+TEST_CASE("Opcode $66", "[ROR]") { testOpcode("66.bin"); }
+TEST_CASE("Opcode $68", "[PLA]") { testOpcode("68.bin"); }
+TEST_CASE("Opcode $69", "[ADC]") { testOpcode("69.bin"); }
+TEST_CASE("Opcode $6a", "[ROR]") { testOpcode("6a.bin"); }
+TEST_CASE("Opcode $6c", "[JMP]") { testOpcode("6c.bin"); }
+TEST_CASE("Opcode $6d", "[ADC]") { testOpcode("6d.bin"); }
+TEST_CASE("Opcode $6e", "[ROR]") { testOpcode("6e.bin"); }
+
+TEST_CASE("Opcode $70", "[BVS]") { testOpcode("70.bin"); }
+TEST_CASE("Opcode $71", "[ADC]") { testOpcode("71.bin"); }
+TEST_CASE("Opcode $75", "[ADC]") { testOpcode("75.bin"); }
+TEST_CASE("Opcode $76", "[ROR]") { testOpcode("76.bin"); }
+TEST_CASE("Opcode $78", "[SEI]") { testOpcode("78.bin"); }
+TEST_CASE("Opcode $79", "[ADC]") { testOpcode("79.bin"); }
+TEST_CASE("Opcode $7d", "[ADC]") { testOpcode("7d.bin"); }
+TEST_CASE("Opcode $7e", "[ROR]") { testOpcode("7e.bin"); }
+
+TEST_CASE("Opcode $81", "[STA]") { testOpcode("81.bin"); }
+TEST_CASE("Opcode $84", "[STY]") { testOpcode("84.bin"); }
+TEST_CASE("Opcode $85", "[STA]") { testOpcode("85.bin"); }
+TEST_CASE("Opcode $86", "[STX]") { testOpcode("86.bin"); }
+TEST_CASE("Opcode $88", "[DEY]") { testOpcode("88.bin"); }
+TEST_CASE("Opcode $8a", "[TXA]") { testOpcode("8a.bin"); }
+TEST_CASE("Opcode $8c", "[STY]") { testOpcode("8c.bin"); }
+TEST_CASE("Opcode $8d", "[STA]") { testOpcode("8d.bin"); }
+TEST_CASE("Opcode $8e", "[STX]") { testOpcode("8e.bin"); }
+
+TEST_CASE("Opcode $90", "[BCC]") { testOpcode("90.bin"); }
+TEST_CASE("Opcode $91", "[STA]") { testOpcode("91.bin"); }
+TEST_CASE("Opcode $94", "[STY]") { testOpcode("94.bin"); }
+TEST_CASE("Opcode $95", "[STA]") { testOpcode("95.bin"); }
+TEST_CASE("Opcode $96", "[STX]") { testOpcode("96.bin"); }
+TEST_CASE("Opcode $98", "[TYA]") { testOpcode("98.bin"); }
+TEST_CASE("Opcode $99", "[STA]") { testOpcode("99.bin"); }
+TEST_CASE("Opcode $9a", "[TXS]") { testOpcode("9a.bin"); }
+TEST_CASE("Opcode $9d", "[STA]") { testOpcode("9d.bin"); }
+
+TEST_CASE("Opcode $a0", "[LDY]") { testOpcode("a0.bin"); }
+TEST_CASE("Opcode $a1", "[LDA]") { testOpcode("a1.bin"); }
+TEST_CASE("Opcode $a2", "[LDX]") { testOpcode("a2.bin"); }
+TEST_CASE("Opcode $a4", "[LDY]") { testOpcode("a4.bin"); }
+TEST_CASE("Opcode $a5", "[LDA]") { testOpcode("a5.bin"); }
+TEST_CASE("Opcode $a6", "[LDX]") { testOpcode("a6.bin"); }
+TEST_CASE("Opcode $a8", "[TAY]") { testOpcode("a8.bin"); }
+TEST_CASE("Opcode $a9", "[LDA]") { testOpcode("a9.bin"); }
+TEST_CASE("Opcode $aa", "[TAX]") { testOpcode("aa.bin"); }
+TEST_CASE("Opcode $ac", "[LDY]") { testOpcode("ac.bin"); }
+TEST_CASE("Opcode $ad", "[LDA]") { testOpcode("ad.bin"); }
+TEST_CASE("Opcode $ae", "[LDX]") { testOpcode("ae.bin"); }
+
+TEST_CASE("Opcode $b0", "[BCS]") { testOpcode("b0.bin"); }
+TEST_CASE("Opcode $b1", "[LDA]") { testOpcode("b1.bin"); }
+TEST_CASE("Opcode $b4", "[LDY]") { testOpcode("b4.bin"); }
+TEST_CASE("Opcode $b5", "[LDA]") { testOpcode("b5.bin"); }
+TEST_CASE("Opcode $b6", "[LDX]") { testOpcode("b6.bin"); }
+TEST_CASE("Opcode $b8", "[CLV]") { testOpcode("b8.bin"); }
+TEST_CASE("Opcode $b9", "[LDA]") { testOpcode("b9.bin"); }
+TEST_CASE("Opcode $ba", "[TSX]") { testOpcode("ba.bin"); }
+TEST_CASE("Opcode $bc", "[LDY]") { testOpcode("bc.bin"); }
+TEST_CASE("Opcode $bd", "[LDA]") { testOpcode("bd.bin"); }
+TEST_CASE("Opcode $be", "[LDX]") { testOpcode("be.bin"); }
+
+TEST_CASE("Opcode $c0", "[CPY]") { testOpcode("c0.bin"); }
+TEST_CASE("Opcode $c1", "[CMP]") { testOpcode("c1.bin"); }
+TEST_CASE("Opcode $c4", "[CPY]") { testOpcode("c4.bin"); }
+TEST_CASE("Opcode $c5", "[CMP]") { testOpcode("c5.bin"); }
+TEST_CASE("Opcode $c6", "[DEC]") { testOpcode("c6.bin"); }
+TEST_CASE("Opcode $c8", "[INY]") { testOpcode("c8.bin"); }
+TEST_CASE("Opcode $c9", "[CMP]") { testOpcode("c9.bin"); }
+TEST_CASE("Opcode $ca", "[DEX]") { testOpcode("ca.bin"); }
+TEST_CASE("Opcode $cc", "[CPY]") { testOpcode("cc.bin"); }
+TEST_CASE("Opcode $cd", "[CMP]") { testOpcode("cd.bin"); }
+TEST_CASE("Opcode $ce", "[DEC]") { testOpcode("ce.bin"); }
+
+TEST_CASE("Opcode $d0", "[BNE]") { testOpcode("d0.bin"); }
+TEST_CASE("Opcode $d1", "[CMP]") { testOpcode("d1.bin"); }
+TEST_CASE("Opcode $d5", "[CMP]") { testOpcode("d5.bin"); }
+TEST_CASE("Opcode $d6", "[DEC]") { testOpcode("d6.bin"); }
+TEST_CASE("Opcode $d8", "[CLD]") { testOpcode("d8.bin"); }
+TEST_CASE("Opcode $d9", "[CMP]") { testOpcode("d9.bin"); }
+TEST_CASE("Opcode $dd", "[CMP]") { testOpcode("dd.bin"); }
+TEST_CASE("Opcode $de", "[DEC]") { testOpcode("de.bin"); }
+
+TEST_CASE("Opcode $e0", "[CPX]") { testOpcode("e0.bin"); }
+TEST_CASE("Opcode $e1", "[SBC]") { testOpcode("e1.bin"); }
+TEST_CASE("Opcode $e4", "[CPX]") { testOpcode("e4.bin"); }
+TEST_CASE("Opcode $e5", "[SBC]") { testOpcode("e5.bin"); }
+TEST_CASE("Opcode $e6", "[INC]") { testOpcode("e6.bin"); }
+TEST_CASE("Opcode $e8", "[INX]") { testOpcode("e8.bin"); }
+TEST_CASE("Opcode $e9", "[SBC]") { testOpcode("e9.bin"); }
+TEST_CASE("Opcode $ea", "[NOP]") { testOpcode("ea.bin"); }
+TEST_CASE("Opcode $ec", "[CPX]") { testOpcode("ec.bin"); }
+TEST_CASE("Opcode $ed", "[SBC]") { testOpcode("ed.bin"); }
+TEST_CASE("Opcode $ee", "[INC]") { testOpcode("ee.bin"); }
+
+TEST_CASE("Opcode $f0", "[BEQ]") { testOpcode("f0.bin"); }
+TEST_CASE("Opcode $f1", "[SBC]") { testOpcode("f1.bin"); }
+TEST_CASE("Opcode $f5", "[SBC]") { testOpcode("f5.bin"); }
+TEST_CASE("Opcode $f6", "[INC]") { testOpcode("f6.bin"); }
+TEST_CASE("Opcode $f8", "[SED]") { testOpcode("f8.bin"); }
+TEST_CASE("Opcode $f9", "[SBC]") { testOpcode("f9.bin"); }
+TEST_CASE("Opcode $fd", "[SBC]") { testOpcode("fd.bin"); }
+TEST_CASE("Opcode $fe", "[INC]") { testOpcode("fe.bin"); }
\ No newline at end of file
@@ -5,6 +5,14 @@ set_languages("c++20")
 
 add_rules("mode.debug", "mode.release")
 
+-- Options --
+option("computed_goto")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Dispatch opcodes with computed goto instead of a function pointer table (GCC/Clang only)")
+    add_defines("NESBUDDY_COMPUTED_GOTO")
+option_end()
+
 -- Dependencies --
 add_requires(
     "catch2",
@@ -17,11 +25,15 @@ add_requires(
 target("nesbuddy")
     set_kind("binary")
     add_files("src/**.cpp")
+    add_options("computed_goto")
     add_packages(
         "fmt",
         "libsdl", 
         "nativefiledialog-extended"
     )
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
     if is_mode("debug") then
         add_ldflags("/subsystem:console")  -- Needed for stdout and stderr to console 
     end
@@ -30,5 +42,30 @@ target("cputest")
     set_kind("binary")
     set_default(false)
     add_files("test/test_CPU.cpp")
-    add_files("src/NES.cpp", "src/CPU/**.cpp", "src/Cartridge/**.cpp")
-    add_packages("catch2", "nlohmann_json", "nativefiledialog-extended")
\ No newline at end of file
+    add_files("src/CPU/**.cpp", "src/MemoryMap.cpp", "src/MappedFile.cpp")
+    add_options("computed_goto")
+    add_packages("catch2")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+
+target("convert_tests")
+    set_kind("binary")
+    set_default(false)
+    add_files("test/convert_tests.cpp")
+    add_packages("fmt", "nlohmann_json")
+
+target("cpubench")
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/bench_CPU.cpp")
+    add_files("src/CPU/**.cpp", "src/Cartridge/**.cpp", "src/PPU/**.cpp")
+    add_files("src/NES.cpp", "src/MemoryMap.cpp", "src/MappedFile.cpp", "src/Rewind.cpp", "src/RunAhead.cpp", "src/Scheduler.cpp", "src/Logger.cpp")
+    add_options("computed_goto")
+    add_packages("fmt", "nativefiledialog-extended")
+
+target("ppubench")
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/bench_PPU.cpp", "src/PPU/PixelKernels.cpp")
+    add_packages("fmt")
\ No newline at end of file